@@ -0,0 +1,19 @@
+"""
+asv benchmarks of rat_trig kernels; see ``asv_bench/README.md``.
+
+The inputs are those of the pytest-benchmark suite, made by ``benchmarks/data.py`` of the
+same checkout. That module is loaded by path, since asv imports this package under the name
+``benchmarks`` too.
+"""
+
+import importlib.util
+import os
+
+_DATA = os.path.join(os.path.dirname(__file__), "..", "..", "benchmarks", "data.py")
+_spec = importlib.util.spec_from_file_location("_rat_trig_bench_data", _DATA)
+data = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(data)
+
+TYPES = list(data.TYPES)
+MAGNITUDES = list(data.MAGNITUDES)
+make_columns = data.make_columns
@@ -0,0 +1,91 @@
+"""Time, peak memory and allocations of archimedes and the expr program"""
+
+import tracemalloc
+
+from rat_trig import trigonom
+from rat_trig.trigonom import archimedes
+
+from . import MAGNITUDES, TYPES, make_columns
+
+# Kernels added later are looked up in `setup`, which raises NotImplementedError at older
+# commits. asv then skips the benchmarks of that class instead of failing the whole module,
+# so each class only holds benchmarks that need the same kernels.
+
+
+def _allocated_blocks(func, *args):
+    """The number of memory blocks allocated by a call that are alive in its result"""
+    tracemalloc.start()
+    try:
+        before = _traced_blocks()
+        result = func(*args)
+        count = _traced_blocks() - before
+        del result
+        return count
+    finally:
+        tracemalloc.stop()
+
+
+def _traced_blocks():
+    return sum(
+        stat.count for stat in tracemalloc.take_snapshot().statistics("filename")
+    )
+
+
+class ArchimedesScalar:
+    params = (TYPES, MAGNITUDES)
+    param_names = ["type", "magnitude"]
+
+    def setup(self, kind, magnitude):
+        self.triangle = [col[0] for col in make_columns(kind, magnitude, 1000)]
+
+    def time_scalar(self, kind, magnitude):
+        archimedes(*self.triangle)
+
+
+class Archimedes:
+    params = (TYPES, MAGNITUDES)
+    param_names = ["type", "magnitude"]
+
+    def setup(self, kind, magnitude):
+        self.batch = getattr(trigonom, "archimedes_batch", None)
+        if self.batch is None:
+            raise NotImplementedError("archimedes_batch is not available")
+        self.columns = make_columns(kind, magnitude, 1000)
+
+    def time_batch(self, kind, magnitude):
+        self.batch(*self.columns)
+
+    def peakmem_batch(self, kind, magnitude):
+        self.batch(*self.columns)
+
+    def track_allocated_blocks(self, kind, magnitude):
+        return _allocated_blocks(self.batch, *self.columns)
+
+    track_allocated_blocks.unit = "blocks"
+
+
+class Program:
+    params = (TYPES, MAGNITUDES)
+    param_names = ["type", "magnitude"]
+
+    def setup(self, kind, magnitude):
+        try:
+            from rat_trig.expr import compile_exprs, var
+        except ImportError:
+            raise NotImplementedError("rat_trig.expr is not available") from None
+        q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+        self.program = compile_exprs({"quadrea": archimedes(q_1, q_2, q_3)})
+        self.columns = dict(
+            zip(("q_1", "q_2", "q_3"), make_columns(kind, magnitude, 1000))
+        )
+
+    def time_quadrea(self, kind, magnitude):
+        self.program(**self.columns)
+
+    def peakmem_quadrea(self, kind, magnitude):
+        self.program(**self.columns)
+
+    def track_allocated_blocks(self, kind, magnitude):
+        return _allocated_blocks(lambda: self.program(**self.columns))
+
+    track_allocated_blocks.unit = "blocks"
@@ -0,0 +1,183 @@
+"""Find the commit that slowed down an asv benchmark, without asv or network access
+
+Each commit of a range is checked out into a temporary git worktree. The benchmarks of the
+current checkout are run against the ``src/`` of that worktree in a fresh interpreter, so
+nothing is installed, and the range is bisected::
+
+    python asv_bench/bisect_regression.py GOOD BAD bench_trigonom.Archimedes.time_batch \\
+        --param fraction --param huge --factor 1.2
+
+A commit counts as slow if the benchmark takes more than ``--factor`` times as long as at
+GOOD. A commit at which the benchmark cannot run, because its ``setup`` raises
+``NotImplementedError`` or the code it imports does not exist yet, is skipped like with
+``git bisect skip``. Only ``time_`` benchmarks are supported.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+from typing import Dict, Optional, Tuple
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+SKIP = 3  # the exit status of _RUNNER for a benchmark that cannot run at a commit
+
+_RUNNER = """
+import importlib, json, sys, timeit
+src, bench_dir, name, raw = sys.argv[1:5]
+sys.path[:0] = [src, bench_dir]
+module, *attrs = name.rsplit(".", 2) if name.count(".") >= 2 else name.rsplit(".", 1)
+try:
+    module = importlib.import_module("benchmarks." + module)
+except ImportError as err:
+    print(err, file=sys.stderr)  # the code under test predates the benchmark
+    sys.exit(3)
+if len(attrs) == 2:
+    cls = getattr(module, attrs[0])
+    owner, func = cls(), attrs[1]
+    choices = getattr(cls, "params", [])
+else:
+    owner, func, choices = module, attrs[0], getattr(module, attrs[0] + "_params", [])
+if choices and not isinstance(choices[0], (list, tuple)):
+    choices = [choices]
+raw = json.loads(raw)
+params = [next(c for c in options if str(c) == r) for options, r in zip(choices, raw)]
+setup = getattr(owner, "setup", None)
+if setup is not None:
+    try:
+        setup(*params)
+    except NotImplementedError as err:
+        print(err, file=sys.stderr)
+        sys.exit(3)
+timer = timeit.Timer(lambda: getattr(owner, func)(*params))
+number, _ = timer.autorange()
+print(min(timer.repeat(5, number)) / number)
+"""
+
+
+def git(*args: str) -> str:
+    return subprocess.run(
+        ["git", *args], cwd=HERE, check=True, capture_output=True, text=True
+    ).stdout.strip()
+
+
+def measure(commit: str, benchmark: str, params) -> Optional[float]:
+    """The time of one call of the benchmark at a commit in seconds, or `None` to skip it"""
+    with tempfile.TemporaryDirectory() as tmp:
+        tree = os.path.join(tmp, "tree")
+        git("worktree", "add", "--detach", tree, commit)
+        try:
+            result = subprocess.run(
+                [
+                    sys.executable,
+                    "-c",
+                    _RUNNER,
+                    os.path.join(tree, "src"),
+                    HERE,
+                    benchmark,
+                    json.dumps(params),
+                ],
+                capture_output=True,
+                text=True,
+            )
+        finally:
+            git("worktree", "remove", "--force", tree)
+    if result.returncode == SKIP:
+        return None
+    if result.returncode:
+        raise RuntimeError(f"benchmark failed at {commit[:10]}:\n{result.stderr}")
+    return float(result.stdout)
+
+
+def bisect(commits, is_slow) -> Tuple[int, int]:
+    """
+    Bisect for the first slow commit, given that the first commit is fast and the last one
+    is slow. `is_slow` returns `None` for a commit that cannot be measured, which is then
+    skipped.
+
+    :return: `(lo, hi)` such that `commits[lo]` is fast, `commits[hi]` is slow, and the first
+        slow commit is `commits[hi]` or one of the skipped commits between them
+    """
+    lo, hi = 0, len(commits) - 1
+    skipped = set()
+    while True:
+        untested = [i for i in range(lo + 1, hi) if i not in skipped]
+        if not untested:
+            return lo, hi
+        middle = (lo + hi) // 2
+        mid = min(untested, key=lambda i: abs(i - middle))
+        slow = is_slow(commits[mid])
+        if slow is None:
+            skipped.add(mid)
+        elif slow:
+            hi = mid
+        else:
+            lo = mid
+
+
+def main(argv=None) -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("good", help="a commit without the regression")
+    parser.add_argument("bad", help="a later commit with the regression")
+    parser.add_argument("benchmark", help="e.g. bench_trigonom.Archimedes.time_batch")
+    parser.add_argument(
+        "--param",
+        action="append",
+        default=[],
+        help="benchmark parameter value, in the order of param_names (repeatable)",
+    )
+    parser.add_argument(
+        "--factor",
+        type=float,
+        default=1.2,
+        help="slowdown relative to GOOD that counts as a regression (default: 1.2)",
+    )
+    args = parser.parse_args(argv)
+    good, bad = git("rev-parse", args.good), git("rev-parse", args.bad)
+    commits = [good] + git(
+        "rev-list", "--reverse", "--ancestry-path", f"{good}..{bad}"
+    ).split()
+    timings: Dict[str, Optional[float]] = {}
+
+    def time_at(commit: str) -> Optional[float]:
+        if commit not in timings:
+            timings[commit] = measure(commit, args.benchmark, args.param)
+            subject = git("log", "-1", "--format=%s", commit)
+            seconds = timings[commit]
+            shown = "skipped" if seconds is None else f"{seconds * 1e6:.2f} us"
+            print(f"{commit[:10]} {shown:>15}  {subject}")
+        return timings[commit]
+
+    baseline, latest = time_at(good), time_at(bad)
+    if baseline is None or latest is None:
+        print("the benchmark cannot run at GOOD or BAD", file=sys.stderr)
+        return 2
+    threshold = baseline * args.factor
+    if latest <= threshold:
+        print(f"no regression: {args.bad} is within {args.factor}x of {args.good}")
+        return 1
+
+    def is_slow(commit: str) -> Optional[bool]:
+        seconds = time_at(commit)
+        return None if seconds is None else seconds > threshold
+
+    lo, hi = bisect(commits, is_slow)
+    first = commits[hi]
+    ratio = timings[first] / baseline
+    subject = git("log", "-1", "--format=%s", first)
+    if hi - lo == 1:
+        print(f"first slow commit: {first[:10]} ({ratio:.2f}x) {subject}")
+    else:
+        print(
+            "the first slow commit is one of these, the others could not be measured:"
+        )
+        for commit in commits[lo + 1 : hi + 1]:
+            print(f"  {commit[:10]} {git('log', '-1', '--format=%s', commit)}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1 @@
+"""Performance benchmarks of rat_trig; see ``conftest.py``."""
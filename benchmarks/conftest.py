@@ -0,0 +1,36 @@
+"""
+Performance benchmarks, run with pytest-benchmark (``pip install rat-trig[bench]``).
+
+They are not part of ``tests/``. Run them with ``tox -e bench``, or directly::
+
+    pytest benchmarks --benchmark-autosave            # save a JSON run in .benchmarks/
+    pytest benchmarks --benchmark-compare \\
+        --benchmark-compare-fail=mean:10%             # fail on a >10% slowdown
+    pytest-benchmark compare --group-by=group         # tabulate the saved runs
+
+The inputs are made by ``data.py``.
+"""
+
+import importlib.util
+
+import pytest
+
+from .data import MAGNITUDES, TYPES, make_columns
+
+if importlib.util.find_spec("pytest_benchmark") is None:  # pragma: no cover
+    collect_ignore_glob = ["test_*.py"]
+
+
+@pytest.fixture(params=TYPES)
+def kind(request):
+    return request.param
+
+
+@pytest.fixture(params=MAGNITUDES)
+def magnitude(request):
+    return request.param
+
+
+@pytest.fixture
+def columns(kind, magnitude):
+    return make_columns(kind, magnitude)
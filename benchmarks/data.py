@@ -0,0 +1,43 @@
+"""
+Benchmark inputs, shared by the pytest-benchmark suite and the asv suite in ``asv_bench/``.
+
+Inputs come in three magnitudes per numeric type. ``small`` values are single digits.
+``medium`` values are those of ``experiments/test.py``. ``huge`` values have
+numerators and denominators of about 256 bits, where the cost of big-integer arithmetic
+dominates.
+
+This module only uses the standard library, so that it can be loaded by file path from a
+checkout that is not installed.
+"""
+
+import random
+from fractions import Fraction
+
+BATCH = 1000
+TYPES = ("int", "float", "fraction")
+MAGNITUDES = ("small", "medium", "huge")
+
+_MEDIUM = {
+    "int": (20000, 40000, 60000),
+    "float": (2.0, 4.0, 6.0),
+    "fraction": (Fraction(1, 2), Fraction(1, 4), Fraction(1, 6)),
+}
+
+
+def make_value(kind: str, magnitude: str, rng: random.Random):
+    """One random quadrance of a numeric type and magnitude"""
+    if magnitude == "medium":
+        return rng.choice(_MEDIUM[kind])
+    bits = 4 if magnitude == "small" else 256
+    num = rng.getrandbits(bits) + 1
+    if kind == "int":
+        return num
+    if kind == "float":
+        return float(num)
+    return Fraction(num, rng.getrandbits(bits) + 1)
+
+
+def make_columns(kind: str, magnitude: str, size: int = BATCH):
+    """Three columns of quadrances, the same for every run"""
+    rng = random.Random(f"{kind}-{magnitude}")
+    return [[make_value(kind, magnitude, rng) for _ in range(size)] for _ in range(3)]
@@ -0,0 +1,63 @@
+"""`archimedes` through the optional backends of the package, on batches of triangles"""
+
+import pytest
+
+from rat_trig.expr import compile_exprs, var
+from rat_trig.intern import memoized_archimedes
+from rat_trig.interval import archimedes_interval_batch
+from rat_trig.lazy import LazyFraction
+from rat_trig.trigonom import archimedes, archimedes_batch
+
+from .data import make_columns
+
+q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+QUADREA = {"quadrea": archimedes(q_1, q_2, q_3)}
+
+
+def test_program(benchmark, columns, kind, magnitude):
+    benchmark.group = f"backends {kind} {magnitude}"
+    program = compile_exprs(QUADREA)
+    q_1s, q_2s, q_3s = columns
+    result = benchmark(program, q_1=q_1s, q_2=q_2s, q_3=q_3s)
+    assert result["quadrea"] == archimedes_batch(*columns)
+
+
+def test_memoized(benchmark, columns, kind, magnitude):
+    benchmark.group = f"backends {kind} {magnitude}"
+    cached = memoized_archimedes(4096)
+    # after the first round every call is a cache hit, the case the cache is meant for
+
+    def loop():
+        return [cached(*q) for q in zip(*columns)]
+
+    assert benchmark(loop) == archimedes_batch(*columns)
+
+
+def test_lazy(benchmark, magnitude):
+    benchmark.group = f"backends fraction {magnitude}"
+    columns = [
+        [LazyFraction(v.numerator, v.denominator) for v in col]
+        for col in make_columns("fraction", magnitude)
+    ]
+    assert len(benchmark(archimedes_batch, *columns)) == len(columns[0])
+
+
+def test_interval(benchmark, magnitude):
+    benchmark.group = f"backends float {magnitude}"
+    columns = make_columns("float", magnitude)
+    lo, hi = benchmark(archimedes_interval_batch, *columns)
+    assert len(lo) == len(hi) == len(columns[0])
+
+
+@pytest.mark.parametrize("ctype", ["double", "int64"])
+def test_native(benchmark, ctype, tmp_path_factory):
+    codegen = pytest.importorskip("rat_trig.codegen")
+    try:
+        kernel = codegen.NativeKernel(QUADREA, ctype, tmp_path_factory.mktemp("native"))
+    except (OSError, RuntimeError) as err:
+        pytest.skip(f"no C compiler: {err}")
+    kind = "float" if ctype == "double" else "int"
+    benchmark.group = f"backends {kind} medium"
+    q_1s, q_2s, q_3s = make_columns(kind, "medium")
+    result = benchmark(kernel, q_1=q_1s, q_2=q_2s, q_3=q_3s)
+    assert list(result["quadrea"]) == archimedes_batch(q_1s, q_2s, q_3s)
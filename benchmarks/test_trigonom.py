@@ -0,0 +1,24 @@
+"""`archimedes` for every numeric type and magnitude, scalar and batch"""
+
+from rat_trig.trigonom import archimedes, archimedes_batch
+
+
+def test_archimedes_scalar(benchmark, columns, kind, magnitude):
+    benchmark.group = f"archimedes {kind} {magnitude}"
+    q_1, q_2, q_3 = (col[0] for col in columns)
+    result = benchmark(archimedes, q_1, q_2, q_3)
+    assert result == archimedes_batch([q_1], [q_2], [q_3])[0]
+
+
+def test_archimedes_loop(benchmark, columns, kind, magnitude):
+    benchmark.group = f"archimedes {kind} {magnitude}"
+
+    def loop(q_1s, q_2s, q_3s):
+        return [archimedes(*q) for q in zip(q_1s, q_2s, q_3s)]
+
+    assert len(benchmark(loop, *columns)) == len(columns[0])
+
+
+def test_archimedes_batch(benchmark, columns, kind, magnitude):
+    benchmark.group = f"archimedes {kind} {magnitude}"
+    assert len(benchmark(archimedes_batch, *columns)) == len(columns[0])
@@ -0,0 +1,31 @@
+"""Batch normalization versus element-by-element Fraction construction
+
+Run with ``python experiments/bench_batch_gcd.py`` after ``pip install -e .``.
+"""
+
+import random
+import timeit
+from fractions import Fraction
+
+from rat_trig.batch_gcd import to_fractions
+from rat_trig.trigonom import archimedes
+
+
+def columns(n, bits):
+    nums = [archimedes(*(random.getrandbits(bits) for _ in range(3))) for _ in range(n)]
+    dens = [random.getrandbits(2 * bits) | 1 for _ in range(n)]
+    return nums, dens
+
+
+if __name__ == "__main__":
+    for bits in (16, 64, 256):
+        nums, dens = columns(100000, bits)
+        loop = min(
+            timeit.repeat(
+                lambda: [Fraction(n, d) for n, d in zip(nums, dens)], number=1, repeat=3
+            )
+        )
+        batch = min(timeit.repeat(lambda: to_fractions(nums, dens), number=1, repeat=3))
+        print(
+            f"{bits:>4} bits: Fraction {loop * 1e3:8.1f} ms, batch {batch * 1e3:8.1f} ms"
+        )
@@ -0,0 +1,43 @@
+"""Result formatting with rat_trig.fmt versus csv.writer and str per value
+
+Run with ``python experiments/bench_fmt.py`` after ``pip install -e .``.
+"""
+
+import csv
+import io
+import random
+import timeit
+from fractions import Fraction
+
+from rat_trig.fmt import format_rows
+
+
+def make_columns(n, kind):
+    def value():
+        if kind == "int":
+            return random.randint(-(10**12), 10**12)
+        return Fraction(random.randint(-(10**9), 10**9), random.randint(1, 10**6))
+
+    return [[value() for _ in range(n)] for _ in range(2)]
+
+
+def baseline(columns):
+    out = io.StringIO()
+    csv.writer(out, lineterminator="\n").writerows(zip(*columns))
+    return out.getvalue()
+
+
+if __name__ == "__main__":
+    n = 100000
+    for kind in ("int", "fraction"):
+        columns = make_columns(n, kind)
+        for name, func in (
+            ("csv.writer", baseline),
+            ("format_rows", format_rows),
+            ("decimal 6", lambda cols: format_rows(cols, "decimal")),
+            ("scientific 6", lambda cols: format_rows(cols, "scientific")),
+        ):
+            t = min(timeit.repeat(lambda: func(columns), number=1, repeat=3))
+            print(
+                f"{kind:>8} {name:>12}: {t * 1e3:7.1f} ms, {n / t / 1e6:5.2f} M rows/s"
+            )
@@ -0,0 +1,47 @@
+"""Per-solve latency of the rational two-link inverse kinematics
+
+Run with ``python experiments/bench_kinematics.py`` after ``pip install -e .``.
+"""
+
+import random
+import timeit
+from fractions import Fraction
+
+from rat_trig.kinematics import solve_two_link, solve_two_link_batch
+
+TICK = 1000  # targets per control tick
+
+
+def make_targets(kind):
+    rng = random.Random(42)
+    coords = [(rng.randint(-90, 90), rng.randint(-90, 90)) for _ in range(TICK)]
+    if kind == "float":
+        return [(x / 10, y / 10) for x, y in coords]
+    if kind == "Fraction":
+        return [(Fraction(x, 10), Fraction(y, 10)) for x, y in coords]
+    return coords
+
+
+def bench(kind, q_1, q_2):
+    targets = make_targets(kind)
+
+    def scalar():
+        for t in targets:
+            solve_two_link(q_1, q_2, t)
+
+    def batch():
+        solve_two_link_batch(q_1, q_2, targets)
+
+    for name, func in (("scalar", scalar), ("batch", batch)):
+        times = timeit.repeat(func, number=1, repeat=50)
+        per_solve = [t / TICK * 1e9 for t in times]
+        print(
+            f"{kind:>8} {name:>6}: median {sorted(per_solve)[25]:8.0f} ns/solve, "
+            f"worst tick {max(times) * 1e3:6.2f} ms"
+        )
+
+
+if __name__ == "__main__":
+    bench("int", 2500, 2500)
+    bench("float", 25.0, 25.0)
+    bench("Fraction", Fraction(25), Fraction(25))
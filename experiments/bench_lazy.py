@@ -0,0 +1,30 @@
+"""LazyFraction versus Fraction on archimedes and on deep formula chains
+
+Run with ``python experiments/bench_lazy.py`` after ``pip install -e .``.
+"""
+
+import timeit
+from fractions import Fraction
+
+from rat_trig.lazy import LazyFraction
+from rat_trig.trigonom import archimedes
+
+
+def chain(q_1, q_2, q_3, depth):
+    """Feed the quadrea back as a quadrance, normalizing only at the end"""
+    for _ in range(depth):
+        q_1, q_2, q_3 = q_2, q_3, archimedes(q_1, q_2, q_3) / (q_1 + q_2 + q_3)
+    return q_1 + q_2 + q_3 == 0
+
+
+def bench(name, stmt, number):
+    for kind in (Fraction, LazyFraction):
+        args = (kind(1, 2), kind(1, 4), kind(1, 6))
+        t = min(timeit.repeat(lambda: stmt(*args), number=number, repeat=5))
+        print(f"{name:>16} {kind.__name__:>12}: {t / number * 1e6:8.2f} us")
+
+
+if __name__ == "__main__":
+    bench("archimedes", lambda *q: archimedes(*q) == 0, 20000)
+    bench("chain depth 4", lambda *q: chain(*q, 4), 2000)
+    bench("chain depth 8", lambda *q: chain(*q, 8), 200)
@@ -0,0 +1,40 @@
+"""Column parsing with rat_trig.parse, with and without the C tokenizer, versus
+Fraction(str) per value
+
+Run with ``python experiments/bench_parse.py`` after ``pip install -e .``.
+"""
+
+import random
+import timeit
+from fractions import Fraction
+
+from rat_trig.parse import iter_chunks
+
+
+def make_lines(n, notation):
+    def field():
+        if notation == "int":
+            return str(random.randint(-(10**9), 10**9))
+        if notation == "fraction":
+            return f"{random.randint(-(10**6), 10**6)}/{random.randint(1, 10**3)}"
+        return f"{random.uniform(-1000, 1000):.6f}"
+
+    return [",".join(field() for _ in range(3)) + "\n" for _ in range(n)]
+
+
+def baseline(lines):
+    return [[Fraction(f) for f in line.split(",")] for line in lines]
+
+
+if __name__ == "__main__":
+    n = 100000
+    for notation in ("int", "fraction", "decimal"):
+        lines = make_lines(n, notation)
+        size = sum(map(len, lines)) / 1e6
+        for name, func in (
+            ("Fraction(str)", baseline),
+            ("iter_chunks", lambda ls: list(iter_chunks(ls, 3))),
+            ("native", lambda ls: list(iter_chunks(ls, 3, native=True))),
+        ):
+            t = min(timeit.repeat(lambda: func(lines), number=1, repeat=3))
+            print(f"{notation:>8} {name:>14}: {t * 1e3:7.1f} ms, {size / t:6.1f} MB/s")
@@ -0,0 +1,62 @@
+"""Scaling of the rat-trig CLI with the number of worker processes
+
+Run with ``python experiments/scale_jobs.py [ROWS]`` after ``pip install -e .``. It writes
+a CSV file of random rational quadrances and times ``rat-trig --jobs N`` for N = 1, 2, 4,
+... up to 64, skipping values beyond the number of CPUs.
+
+No multi-core numbers have been recorded yet. The only machine this has run on had one CPU,
+where ``--jobs 1`` is on par with the serial path; the scaling from 1 to 64 cores is
+unmeasured.
+"""
+
+import io
+import os
+import random
+import sys
+import tempfile
+import time
+
+from rat_trig.skeleton import build_program, process_file_parallel, process_stream
+
+FORMULAS = ["quadrea", "spread_1", "spread_2", "spread_3"]
+
+
+def make_input(path, rows):
+    with open(path, "w") as stream:
+        for _ in range(rows):
+            q = (
+                f"{random.randint(1, 10**6)}/{random.randint(1, 10**3)}"
+                for _ in range(3)
+            )
+            stream.write(",".join(q) + "\n")
+
+
+def time_serial(path):
+    start = time.perf_counter()
+    with open(path, newline="") as stream:
+        process_stream(stream, build_program(FORMULAS), "fraction", io.StringIO())
+    return time.perf_counter() - start
+
+
+def time_jobs(path, jobs):
+    start = time.perf_counter()
+    process_file_parallel(path, FORMULAS, "quadrances", "fraction", io.StringIO(), jobs)
+    return time.perf_counter() - start
+
+
+if __name__ == "__main__":
+    rows = int(sys.argv[1]) if len(sys.argv) > 1 else 200000
+    cpus = os.cpu_count() or 1
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "triangles.csv")
+        make_input(path, rows)
+        base = time_serial(path)
+        print(f"{rows} rows, {cpus} CPUs")
+        print(f"serial    : {base:7.2f} s  {rows / base:10,.0f} rows/s")
+        for jobs in (1, 2, 4, 8, 16, 32, 64):
+            if jobs > cpus:
+                break
+            t = time_jobs(path, jobs)
+            print(
+                f"jobs {jobs:>4} : {t:7.2f} s  {rows / t:10,.0f} rows/s  x{base / t:5.2f}"
+            )
@@ -0,0 +1,148 @@
+"""
+Asynchronous streaming evaluation of batch kernels.
+
+The batch functions of this package block while they run, which stalls an asyncio event loop.
+The functions of this module take an async iterator of input chunks, evaluate each chunk in a
+thread or process pool, and yield the results in input order.
+
+At most `max_in_flight` chunks are evaluated or waiting at any time. The source is read only
+when there is room, so a fast producer is slowed down to the pace of the pool and of the
+consumer, and memory stays bounded. If the consumer stops early or is cancelled, chunks that
+have not started are cancelled and the source is closed. Chunks already running in a pool
+run to completion, since threads cannot be interrupted.
+
+A process pool needs a function and chunks that can be pickled, such as `archimedes_batch`
+and columns of numbers. A `rat_trig.expr.Program` is pickled as its formulas and compiled
+again in the worker, once per worker. The default executor of the event loop is a thread
+pool.
+"""
+
+import asyncio
+import collections
+from concurrent.futures import Executor
+from typing import (
+    Any,
+    AsyncIterable,
+    AsyncIterator,
+    Callable,
+    Deque,
+    List,
+    Mapping,
+    Optional,
+    Sequence,
+    TypeVar,
+)
+
+from .expr import Program
+from .trigonom import archimedes_batch
+
+R = TypeVar("R")
+
+
+async def map_chunks(
+    func: Callable[..., R],
+    chunks: AsyncIterable[Sequence[Any]],
+    executor: Optional[Executor] = None,
+    max_in_flight: int = 4,
+) -> AsyncIterator[R]:
+    """
+    The function `map_chunks` evaluates `func(*chunk)` in an executor for every chunk of an
+    async iterable, and yields the results in order.
+
+    :param func: The function, called with the columns of a chunk as arguments
+    :type func: Callable[..., R]
+    :param chunks: The input chunks, each a sequence of columns
+    :type chunks: AsyncIterable[Sequence[Any]]
+    :param executor: A thread or process pool, by default that of the event loop
+    :type executor: Optional[Executor]
+    :param max_in_flight: The maximum number of chunks submitted and not yet yielded
+    :type max_in_flight: int
+
+    Example:
+        >>> def products(xs, ys):
+        ...     return [x * y for x, y in zip(xs, ys)]
+        >>> async def demo():
+        ...     async def chunks():
+        ...         yield [1, 2], [3, 4]
+        ...         yield [5], [6]
+        ...     return [r async for r in map_chunks(products, chunks())]
+        >>> asyncio.run(demo())
+        [[3, 8], [30]]
+    """
+    if max_in_flight < 1:
+        raise ValueError("max_in_flight must be positive")
+    loop = asyncio.get_running_loop()
+    source = chunks.__aiter__()
+    pending: Deque["asyncio.Future[R]"] = collections.deque()
+    exhausted = False
+    try:
+        while True:
+            while not exhausted and len(pending) < max_in_flight:
+                try:
+                    chunk = await source.__anext__()
+                except StopAsyncIteration:
+                    exhausted = True
+                else:
+                    pending.append(loop.run_in_executor(executor, func, *chunk))
+            if not pending:
+                return
+            yield await pending.popleft()
+    finally:
+        for future in pending:
+            future.cancel()
+        aclose = getattr(source, "aclose", None)
+        if aclose is not None:
+            await aclose()
+
+
+def archimedes_stream(
+    chunks: AsyncIterable[Sequence[Sequence]],
+    executor: Optional[Executor] = None,
+    max_in_flight: int = 4,
+) -> AsyncIterator[List]:
+    """
+    The function `archimedes_stream` computes the quadreas of a stream of chunks of
+    quadrance columns `(q_1s, q_2s, q_3s)`.
+
+    :return: one list of quadreas per chunk, in order
+
+    Example:
+        >>> async def demo():
+        ...     async def chunks():
+        ...         yield [2, 1], [4, 1], [6, 4]
+        ...     return [r async for r in archimedes_stream(chunks())]
+        >>> asyncio.run(demo())
+        [[32, 0]]
+    """
+    return map_chunks(archimedes_batch, chunks, executor, max_in_flight)
+
+
+def _call_program(program: Program, columns: Mapping[str, Sequence]) -> dict:
+    return program(**columns)
+
+
+async def _with_program(program: Program, chunks: AsyncIterable) -> AsyncIterator:
+    source = chunks.__aiter__()
+    try:
+        async for columns in source:
+            yield program, columns
+    finally:
+        aclose = getattr(source, "aclose", None)
+        if aclose is not None:
+            await aclose()
+
+
+def program_stream(
+    program: Program,
+    chunks: AsyncIterable[Mapping[str, Sequence]],
+    executor: Optional[Executor] = None,
+    max_in_flight: int = 4,
+) -> AsyncIterator[dict]:
+    """
+    The function `program_stream` evaluates a compiled `rat_trig.expr.Program` on a stream
+    of chunks, each a mapping of variable names to columns.
+
+    :return: one mapping of formula names to result columns per chunk, in order
+    """
+    pairs = _with_program(program, chunks)
+    return map_chunks(_call_program, pairs, executor, max_in_flight)
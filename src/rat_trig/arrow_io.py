@@ -0,0 +1,296 @@
+"""
+Apache Arrow and Parquet columnar I/O for rational geometry data.
+
+Arrow `int64` and `float64` columns without nulls are mapped zero-copy to `memoryview`
+objects (`column_view`), which the batch functions of this package accept like any other
+sequence. Exact rationals use the `RationalType` extension type, stored as a struct of a
+numerator and a denominator column. Both are `int64` when every value fits, and
+`decimal256(76, 0)` otherwise. Plain integer columns too large for `int64` also use
+`decimal256(76, 0)`. A stream of batches needs one type for all of them, so
+`archimedes_batches` writes exact results as `decimal256(76, 0)` storage whatever their size.
+
+Parquet files are streamed batch by batch with `pyarrow.parquet.ParquetFile.iter_batches`,
+which reads one row group at a time and decodes columns on Arrow's thread pool, so a file
+larger than memory can be processed with `archimedes_parquet`.
+
+This module needs the optional dependency `pyarrow` (`pip install rat-trig[arrow]`).
+"""
+
+import os
+import tempfile
+from array import array
+from decimal import Decimal
+from fractions import Fraction
+from typing import Iterable, Iterator, List, Optional, Sequence, Union
+
+from .batch_gcd import to_fractions
+from .trigonom import archimedes_batch
+
+try:
+    import pyarrow as pa
+    import pyarrow.parquet as pq
+except ImportError:  # pragma: no cover
+    pa = pq = None
+
+Number = Union[int, Fraction, float]
+QUADRANCES = ("q_1", "q_2", "q_3")
+_DECIMAL_DIGITS = 76
+
+
+def _require() -> None:
+    if pa is None:  # pragma: no cover
+        raise ImportError(
+            "rat_trig.arrow_io needs pyarrow: pip install rat-trig[arrow]"
+        )
+
+
+if pa is not None:
+
+    class RationalType(pa.ExtensionType):
+        """Exact rationals, stored as `struct<num: T, den: T>` in lowest terms"""
+
+        def __init__(self, value_type=None) -> None:
+            value_type = pa.int64() if value_type is None else value_type
+            storage = pa.struct([("num", value_type), ("den", value_type)])
+            super().__init__(storage, "rat_trig.rational")
+
+        def __arrow_ext_serialize__(self) -> bytes:
+            return b""
+
+        @classmethod
+        def __arrow_ext_deserialize__(cls, storage_type, serialized) -> "RationalType":
+            return cls(storage_type.field(0).type)
+
+    try:
+        pa.register_extension_type(RationalType())
+    except pa.ArrowKeyError:  # pragma: no cover (module reloaded)
+        pass
+
+
+def column_view(column) -> memoryview:
+    """
+    The function `column_view` returns a zero-copy view of an Arrow `int64` or `float64`
+    array without nulls.
+
+    :param column: The array; a chunked array must have a single chunk
+    :raises ValueError: if the array has nulls or several chunks
+    :raises TypeError: for other value types
+    :return: a read-only `memoryview` of format `"q"` or `"d"`
+    """
+    _require()
+    if isinstance(column, pa.ChunkedArray):
+        if column.num_chunks != 1:
+            raise ValueError("a zero-copy view needs a single chunk")
+        column = column.chunk(0)
+    if column.null_count:
+        raise ValueError("a zero-copy view needs a column without nulls")
+    if column.type == pa.int64():
+        code = "q"
+    elif column.type == pa.float64():
+        code = "d"
+    else:
+        raise TypeError(f"no zero-copy view for {column.type}")
+    data = memoryview(column.buffers()[1]).cast(code)
+    return data[column.offset : column.offset + len(column)]
+
+
+def to_values(column) -> Sequence[Number]:
+    """
+    The function `to_values` converts an Arrow array to a sequence the batch kernels accept.
+
+    `int64` and `float64` columns are zero-copy views, decimal columns become `int` lists,
+    and `RationalType` columns become `Fraction` lists.
+    """
+    _require()
+    if isinstance(column, pa.ChunkedArray):
+        column = column.combine_chunks()
+    if isinstance(column.type, RationalType):
+        storage = column.storage
+        nums, dens = (to_values(storage.field(k)) for k in ("num", "den"))
+        return to_fractions(list(nums), list(dens))
+    if column.type in (pa.int64(), pa.float64()) and not column.null_count:
+        return column_view(column)
+    if pa.types.is_decimal(column.type) and column.type.scale == 0:
+        return [int(v) for v in column.to_pylist()]
+    return column.to_pylist()
+
+
+def _int_array(values: Sequence[int], wide: bool = False):
+    if not wide:
+        try:
+            data = array("q", values)
+        except OverflowError:
+            wide = True
+        else:
+            return pa.Array.from_buffers(
+                pa.int64(), len(data), [None, pa.py_buffer(data)]
+            )
+    if any(len(str(abs(v))) > _DECIMAL_DIGITS for v in values):
+        raise OverflowError(f"integer with more than {_DECIMAL_DIGITS} digits")
+    return pa.array(map(Decimal, values), pa.decimal256(_DECIMAL_DIGITS, 0))
+
+
+def from_values(values: Sequence[Number], type=None):
+    """
+    The function `from_values` converts results of the batch kernels to an Arrow array.
+
+    :param values: `int`, `Fraction` or `float` values, all of one kind
+    :param type: The type of the array, by default the narrowest type that holds the values
+    :raises OverflowError: if an integer has more than 76 decimal digits, or the values do
+        not fit `type`
+    :return: an `int64`, `decimal256(76, 0)`, `float64` or `RationalType` array
+    """
+    _require()
+    explicit = type is not None
+    if type is None:
+        if any(isinstance(v, Fraction) for v in values):
+            type = RationalType()
+        elif any(isinstance(v, float) for v in values):
+            type = pa.float64()
+    if isinstance(type, RationalType):
+        fracs = [Fraction(v) for v in values]
+        nums = [f.numerator for f in fracs]
+        dens = [f.denominator for f in fracs]
+        num_col = _int_array(nums, wide=type != RationalType())
+        den_col = _int_array(dens, wide=num_col.type != pa.int64())
+        if den_col.type != num_col.type:
+            num_col = _int_array(nums, wide=True)
+        storage = pa.StructArray.from_arrays([num_col, den_col], ["num", "den"])
+        column = pa.ExtensionArray.from_storage(RationalType(num_col.type), storage)
+    elif type == pa.float64():
+        data = array("d", map(float, values))
+        column = pa.Array.from_buffers(
+            pa.float64(), len(data), [None, pa.py_buffer(data)]
+        )
+    else:
+        column = _int_array(values, wide=explicit and type != pa.int64())
+    if explicit and column.type != type:
+        raise OverflowError(f"values do not fit {type}")
+    return column
+
+
+def iter_batches(
+    path,
+    columns: Optional[Sequence[str]] = None,
+    batch_size: int = 65536,
+    use_threads: bool = True,
+) -> Iterator["pa.RecordBatch"]:
+    """
+    The function `iter_batches` streams record batches from a Parquet file, one row group at
+    a time.
+
+    :param path: The Parquet file
+    :param columns: The columns to read, by default all
+    :type columns: Optional[Sequence[str]]
+    :param batch_size: The maximum number of rows per batch
+    :type batch_size: int
+    :param use_threads: Decode columns in parallel on Arrow's thread pool
+    :type use_threads: bool
+    """
+    _require()
+    with pq.ParquetFile(path) as reader:
+        yield from reader.iter_batches(
+            batch_size=batch_size,
+            columns=None if columns is None else list(columns),
+            use_threads=use_threads,
+        )
+
+
+def write_parquet(path, batches: Iterable["pa.RecordBatch"]) -> int:
+    """
+    The function `write_parquet` streams record batches to a Parquet file; the schema is
+    that of the first batch. The batches are written to a temporary file next to `path`,
+    which replaces `path` once all of them are written, so a failure leaves no partial file.
+
+    :raises ValueError: if a batch has a different schema than the first one
+    :return: the number of rows written
+    """
+    _require()
+    directory = os.path.dirname(os.path.abspath(path))
+    fd, tmp = tempfile.mkstemp(prefix=".parquet-", dir=directory)
+    os.close(fd)
+    writer = None
+    rows = 0
+    try:
+        for batch in batches:
+            if writer is None:
+                writer = pq.ParquetWriter(tmp, batch.schema)
+            elif batch.schema != writer.schema:
+                raise ValueError(
+                    f"batch schema {batch.schema} differs from {writer.schema}"
+                )
+            writer.write_batch(batch)
+            rows += batch.num_rows
+    except BaseException:
+        if writer is not None:
+            writer.close()
+        os.unlink(tmp)
+        raise
+    if writer is None:
+        os.unlink(tmp)
+    else:
+        writer.close()
+        os.replace(tmp, path)
+    return rows
+
+
+def _output_type(types):
+    wide = pa.decimal256(_DECIMAL_DIGITS, 0)
+    if any(pa.types.is_floating(t) for t in types):
+        return pa.float64()
+    if any(isinstance(t, RationalType) for t in types):
+        return RationalType(wide)
+    return wide
+
+
+def archimedes_batches(
+    batches: Iterable["pa.RecordBatch"],
+    names: Sequence[str] = QUADRANCES,
+    output: str = "quadrea",
+) -> Iterator["pa.RecordBatch"]:
+    """
+    The function `archimedes_batches` computes the quadreas of the triangles in a stream of
+    record batches.
+
+    :param batches: The input batches
+    :param names: The three quadrance columns
+    :type names: Sequence[str]
+    :param output: The name of the result column
+    :type output: str
+    :return: one batch with the single column `output` per input batch, of type `float64`
+        if an input column is floating point, `RationalType` with `decimal256(76, 0)`
+        storage if one is rational, and `decimal256(76, 0)` otherwise
+    """
+    _require()
+    out_type = None
+    for batch in batches:
+        if out_type is None:
+            out_type = _output_type([batch.schema.field(n).type for n in names])
+        cols: List[Sequence[Number]] = [to_values(batch.column(n)) for n in names]
+        result = from_values(archimedes_batch(*cols), out_type)
+        yield pa.RecordBatch.from_arrays([result], [output])
+
+
+def archimedes_parquet(
+    src,
+    dst,
+    names: Sequence[str] = QUADRANCES,
+    output: str = "quadrea",
+    batch_size: int = 65536,
+) -> int:
+    """
+    The function `archimedes_parquet` computes the quadreas of the triangles in a Parquet
+    file and streams them to another Parquet file, without loading either file as a whole.
+
+    :param src: The input file, with the three quadrance columns
+    :param dst: The output file
+    :param names: The three quadrance columns
+    :type names: Sequence[str]
+    :param output: The name of the result column
+    :type output: str
+    :param batch_size: The maximum number of rows per batch
+    :type batch_size: int
+    :return: the number of rows processed
+    """
+    batches = iter_batches(src, names, batch_size)
+    return write_parquet(dst, archimedes_batches(batches, names, output))
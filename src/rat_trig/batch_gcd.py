@@ -0,0 +1,168 @@
+"""
+Fast normalization of rational columns, and product/remainder-tree batch gcd.
+
+`normalize_batch` reduces whole columns of numerators and denominators at once. The gcds,
+quotients and sign fixes are computed with `map` over `math.gcd` and `operator.floordiv`, so
+the per-element work runs in C (CPython's `math.gcd` uses Lehmer's algorithm for multi-digit
+integers), and `to_fractions` then builds the `Fraction` objects without reducing them again.
+The gain over `Fraction(n, d)` comes from skipping the constructor's own reduction and
+argument checks, not from sharing work: the gcd of a numerator and its denominator involves
+only that pair, so there is no work for a product tree to share.
+
+`product_tree`, `remainder_tree` and `batch_gcd` implement Bernstein's batch gcd, which computes
+the gcd of every element with the product of all the other elements in quasi-linear time. It
+answers a different question, e.g. which denominators of a column share factors with any
+other denominator, and is not used by `normalize_batch`.
+"""
+
+import operator
+from fractions import Fraction
+from math import gcd
+from typing import Callable, Iterable, List, Sequence, Tuple
+
+_floordiv = operator.floordiv
+
+if hasattr(Fraction, "_from_coprime_ints"):  # pragma: no cover (Python >= 3.12)
+    _private_coprime = Fraction._from_coprime_ints
+else:  # pragma: no cover
+
+    def _private_coprime(num: int, den: int) -> Fraction:
+        # what `Fraction._from_coprime_ints` does, bypassing the argument checks of `__new__`
+        result = object.__new__(Fraction)
+        result._numerator, result._denominator = num, den
+        return result
+
+
+def _select_coprime(factory: Callable[[int, int], Fraction]) -> Callable:
+    """
+    The private constructor if it builds correct `Fraction` objects on this Python version,
+    and otherwise the public constructor, which reduces its arguments again.
+    """
+    expected = Fraction(-3, 4)
+    try:
+        value = factory(-3, 4)
+        works = (
+            value == expected
+            and value.denominator == 4
+            and hash(value) == hash(expected)
+        )
+    except Exception:
+        works = False
+    return factory if works else Fraction
+
+
+_coprime = _select_coprime(_private_coprime)
+
+
+def normalize_batch(
+    nums: Sequence[int], dens: Sequence[int]
+) -> Tuple[List[int], List[int]]:
+    """
+    The function `normalize_batch` reduces columns of numerators and denominators to lowest
+    terms with positive denominators.
+
+    :param nums: The numerators
+    :type nums: Sequence[int]
+    :param dens: The denominators, nonzero
+    :type dens: Sequence[int]
+    :raises ZeroDivisionError: if a denominator is zero
+    :return: the reduced numerators and denominators
+
+    Example:
+        >>> normalize_batch([4, 3, -6, 0], [6, -9, 4, 5])
+        ([2, -1, -3, 0], [3, 3, 2, 1])
+    """
+    if len(nums) != len(dens):
+        raise ValueError("columns differ in length")
+    if not dens:
+        return [], []
+    if 0 in dens:
+        raise ZeroDivisionError("zero denominator")
+    gs = list(map(gcd, nums, dens))
+    if min(dens) < 0:
+        # a gcd with the sign of the denominator makes every reduced denominator positive
+        gs = [g if d > 0 else -g for g, d in zip(gs, dens)]
+    return list(map(_floordiv, nums, gs)), list(map(_floordiv, dens, gs))
+
+
+def to_fractions(nums: Sequence[int], dens: Sequence[int]) -> List[Fraction]:
+    """
+    The function `to_fractions` normalizes columns of numerators and denominators and returns
+    them as `Fraction` objects, without a second reduction in the `Fraction` constructor.
+
+    Example:
+        >>> to_fractions([2, 10], [4, -5])
+        [Fraction(1, 2), Fraction(-2, 1)]
+    """
+    return list(map(_coprime, *normalize_batch(nums, dens)))
+
+
+def product_tree(values: Sequence[int]) -> List[List[int]]:
+    """
+    The function `product_tree` builds the levels of the binary product tree of the values,
+    from the leaves (the values themselves) to the root (their product).
+
+    Example:
+        >>> product_tree([2, 3, 5])
+        [[2, 3, 5], [6, 5], [30]]
+    """
+    if not values:
+        raise ValueError("empty product tree")
+    tree = [list(values)]
+    while len(tree[-1]) > 1:
+        level = tree[-1]
+        up = list(map(operator.mul, level[0::2], level[1::2]))
+        if len(level) % 2:
+            up.append(level[-1])
+        tree.append(up)
+    return tree
+
+
+def remainder_tree(
+    value: int, tree: List[List[int]], square: bool = False
+) -> List[int]:
+    """
+    The function `remainder_tree` computes `value` modulo every leaf of a product tree by
+    reducing down the tree, which is faster than reducing by each leaf separately.
+
+    :param value: The value to reduce
+    :type value: int
+    :param tree: The product tree of the moduli
+    :type tree: List[List[int]]
+    :param square: Reduce modulo the squares of the tree nodes instead
+    :type square: bool
+    :return: the remainders, one per leaf
+
+    Example:
+        >>> remainder_tree(100, product_tree([3, 7, 11]))
+        [1, 2, 1]
+    """
+    rems = [value]
+    for level in reversed(tree):
+        rems = [rems[i // 2] % (m * m if square else m) for i, m in enumerate(level)]
+    return rems
+
+
+def batch_gcd(values: Sequence[int]) -> List[int]:
+    """
+    The function `batch_gcd` computes, for every value, its gcd with the product of all the
+    other values, using a product tree and a remainder tree (Bernstein's batch gcd).
+
+    :param values: Positive integers
+    :type values: Sequence[int]
+    :return: `gcd(values[i], prod(values[j] for j != i))` for every `i`
+
+    Example:
+        >>> batch_gcd([6, 35, 11, 10])
+        [2, 5, 1, 10]
+    """
+    if len(values) < 2:
+        return [1] * len(values)
+    tree = product_tree(values)
+    rems = remainder_tree(tree[-1][0], tree, square=True)
+    return [gcd(r // v, v) for r, v in zip(rems, values)]
+
+
+def shared_factor_mask(values: Iterable[int]) -> List[bool]:
+    """Whether each value shares a factor with some other value of the column"""
+    return [g > 1 for g in batch_gcd(list(values))]
@@ -0,0 +1,110 @@
+"""
+Atomic checkpoints for resumable batch runs.
+
+A checkpoint records how far a run has got: the byte offset and line number reached in the
+input, the number of rows processed, and the length of the output written so far. It is
+saved as JSON to a temporary file in the same directory, flushed to disk, and renamed over
+the previous checkpoint with `os.replace`. A crash therefore leaves either the old or the new
+checkpoint, never a partial one.
+
+A run that resumes truncates its output to the recorded length, which drops anything
+written after the checkpoint, and continues from the recorded input offset. The fingerprint
+ties a checkpoint to its input file and to the settings of the run, so a checkpoint is never
+applied to different data.
+"""
+
+import hashlib
+import json
+import os
+import tempfile
+from typing import NamedTuple, Optional
+
+
+class CheckpointError(ValueError):
+    """The checkpoint file is unreadable or belongs to another run"""
+
+
+class Checkpoint(NamedTuple):
+    """The progress of a run"""
+
+    fingerprint: str
+    input_offset: int = 0
+    lines: int = 0
+    rows: int = 0
+    output_offset: int = 0
+
+
+def fingerprint(path, *settings) -> str:
+    """
+    The function `fingerprint` identifies an input file and the settings of a run.
+
+    :param path: The input file; its absolute path, size and modification time are used
+    :param settings: Any JSON-serializable settings that change the output
+    :return: a hexadecimal digest
+    """
+    stat = os.stat(path)
+    key = [os.path.abspath(path), stat.st_size, stat.st_mtime_ns, list(settings)]
+    return hashlib.sha256(json.dumps(key).encode()).hexdigest()
+
+
+def _fsync_dir(directory: str) -> None:
+    try:
+        fd = os.open(directory, os.O_RDONLY)
+    except OSError:  # pragma: no cover (platforms without directory handles)
+        return
+    try:
+        os.fsync(fd)
+    except OSError:  # pragma: no cover
+        pass
+    finally:
+        os.close(fd)
+
+
+def save_checkpoint(path, state: Checkpoint) -> None:
+    """
+    The function `save_checkpoint` replaces a checkpoint file atomically.
+
+    Example:
+        >>> import tempfile, os
+        >>> path = os.path.join(tempfile.mkdtemp(), "run.ckpt")
+        >>> save_checkpoint(path, Checkpoint("abc", 120, 10, 9, 64))
+        >>> load_checkpoint(path)
+        Checkpoint(fingerprint='abc', input_offset=120, lines=10, rows=9, output_offset=64)
+    """
+    directory = os.path.dirname(os.path.abspath(path))
+    fd, tmp = tempfile.mkstemp(prefix=".ckpt-", dir=directory)
+    try:
+        with os.fdopen(fd, "w") as stream:
+            json.dump(state._asdict(), stream)
+            stream.flush()
+            os.fsync(stream.fileno())
+        os.replace(tmp, path)
+    except BaseException:
+        os.unlink(tmp)
+        raise
+    _fsync_dir(directory)
+
+
+def load_checkpoint(path) -> Optional[Checkpoint]:
+    """
+    The function `load_checkpoint` reads a checkpoint file.
+
+    :raises CheckpointError: if the file is not a valid checkpoint
+    :return: the checkpoint, or `None` if the file does not exist
+    """
+    try:
+        with open(path) as stream:
+            data = json.load(stream)
+        return Checkpoint(**data)
+    except FileNotFoundError:
+        return None
+    except (ValueError, TypeError) as err:
+        raise CheckpointError(f"invalid checkpoint {path}: {err}") from None
+
+
+def remove_checkpoint(path) -> None:
+    """Delete a checkpoint file after the run has completed"""
+    try:
+        os.remove(path)
+    except FileNotFoundError:
+        pass
@@ -0,0 +1,198 @@
+"""
+Cocircularity detection over planar point sets.
+
+Four points lie on a common circle exactly when Archimedes' formula vanishes for the
+products of the opposite quadrances (Ptolemy's theorem in rational form). Testing every
+quadruple that way costs O(N^4) calls of `archimedes`. This module instead computes an exact
+canonical key for the circle through three points -- its centre and circumquadrance in lowest
+terms -- and groups points by hashing those keys. For a fixed anchor point the centre alone
+determines the circle, so all cocircular groups are found with O(N^3) key computations.
+
+Every group is reported exactly once, by the anchor with the smallest index among its members,
+which also makes the anchors independent units of work for the parallel mode. Coincident
+points are merged before the search, so each distinct point counts once towards the size of a
+group, and a group lists the indices of all copies of its points.
+"""
+
+from concurrent.futures import ProcessPoolExecutor
+from fractions import Fraction
+from math import gcd
+from typing import Dict, Iterator, List, NamedTuple, Optional, Sequence, Tuple, Union
+
+from .trigonom import archimedes, quadrance
+
+Rational = Union[int, Fraction]
+Point = Tuple[Rational, Rational]
+CircleKey = Tuple[Fraction, Fraction, Fraction]
+
+
+class CocircularGroup(NamedTuple):
+    """A maximal set of (at least `min_size`) input points on one circle"""
+
+    center: Tuple[Fraction, Fraction]
+    quadrance: Fraction
+    indices: Tuple[int, ...]
+
+
+def _exact(points: Sequence[Sequence]) -> List[Point]:
+    """Convert coordinates to a single exact type (all `int`, otherwise all `Fraction`)"""
+    if all(type(x) is int and type(y) is int for x, y in points):
+        return [(x, y) for x, y in points]
+    return [(Fraction(x), Fraction(y)) for x, y in points]
+
+
+def circle_key(p_1: Sequence, p_2: Sequence, p_3: Sequence) -> Optional[CircleKey]:
+    r"""
+    The function `circle_key` computes the canonical key of the circle passing through three
+    points: the coordinates of its centre and its circumquadrance, each as a `Fraction` in lowest
+    terms. The circumquadrance is obtained from the quadrea of the triangle as
+    \(q_1 q_2 q_3 / A(q_1, q_2, q_3)\).
+
+    :param p_1: The first point as an `(x, y)` pair of `int`, `Fraction` or `float`
+    :type p_1: Sequence
+    :param p_2: The second point
+    :type p_2: Sequence
+    :param p_3: The third point
+    :type p_3: Sequence
+    :return: the key `(cx, cy, quadrance)`, or `None` if the points are collinear (including
+        coincident points)
+
+    Example:
+        >>> circle_key((0, 0), (2, 0), (0, 2))
+        (Fraction(1, 1), Fraction(1, 1), Fraction(2, 1))
+        >>> circle_key((0, 0), (1, 1), (2, 2)) is None
+        True
+    """
+    (x_1, y_1), (x_2, y_2), (x_3, y_3) = _exact([p_1, p_2, p_3])
+    q_1 = quadrance((x_2, y_2), (x_3, y_3))
+    q_2 = quadrance((x_1, y_1), (x_3, y_3))
+    q_3 = quadrance((x_1, y_1), (x_2, y_2))
+    quadrea = archimedes(q_1, q_2, q_3)
+    if quadrea == 0:
+        return None
+    cx, cy = _center(x_1, y_1, x_2, y_2, x_3, y_3)
+    return (Fraction(x_1 + cx), Fraction(y_1 + cy), Fraction(q_1 * q_2 * q_3) / quadrea)
+
+
+def _center(x_1, y_1, x_2, y_2, x_3, y_3) -> Tuple[Fraction, Fraction]:
+    """Centre of the circumcircle relative to the first point (points must not be collinear)"""
+    ax, ay = x_2 - x_1, y_2 - y_1
+    bx, by = x_3 - x_1, y_3 - y_1
+    qa, qb = ax * ax + ay * ay, bx * bx + by * by
+    det = 2 * (ax * by - ay * bx)
+    return Fraction(by * qa - ay * qb, det), Fraction(ax * qb - bx * qa, det)
+
+
+def _anchor_groups(
+    points: Sequence[Point], i: int, min_size: int
+) -> List[CocircularGroup]:
+    """All cocircular groups whose smallest member index is `i`"""
+    x_0, y_0 = points[i]
+    rest = []
+    for j in range(i + 1, len(points)):
+        ax, ay = points[j][0] - x_0, points[j][1] - y_0
+        rest.append((j, ax, ay, ax * ax + ay * ay))
+    buckets: Dict[tuple, set] = {}
+    for n, (j, ax, ay, qa) in enumerate(rest):
+        for k, bx, by, qb in rest[n + 1 :]:
+            det = ax * by - ay * bx
+            if det == 0:
+                continue
+            nx = by * qa - ay * qb
+            ny = ax * qb - bx * qa
+            if type(det) is int:
+                # integer fast path: the centre is (nx, ny) / (2 det), keyed by the reduced triple
+                g = gcd(gcd(nx, ny), det)
+                if det < 0:
+                    g = -g
+                key: tuple = (nx // g, ny // g, det // g)
+            else:
+                key = (nx / det, ny / det)
+            members = buckets.get(key)
+            if members is None:
+                buckets[key] = {j, k}
+            else:
+                members.add(j)
+                members.add(k)
+
+    groups = []
+    for members in buckets.values():
+        if len(members) + 1 >= min_size:
+            j, k = sorted(members)[:2]
+            cx, cy, quad = circle_key(points[i], points[j], points[k])
+            if any(quadrance(p, (cx, cy)) == quad for p in points[:i]):
+                continue  # already reported by a smaller anchor
+            groups.append(CocircularGroup((cx, cy), quad, (i, *sorted(members))))
+    groups.sort(key=lambda g: g.indices)
+    return groups
+
+
+_WORKER_POINTS: List[Point] = []
+
+
+def _init_worker(points: List[Point]) -> None:
+    global _WORKER_POINTS
+    _WORKER_POINTS = points
+
+
+def _worker_groups(args: Tuple[int, int]) -> List[CocircularGroup]:
+    i, min_size = args
+    return _anchor_groups(_WORKER_POINTS, i, min_size)
+
+
+def cocircular_groups(
+    points: Sequence[Sequence], min_size: int = 4, processes: Optional[int] = None
+) -> Iterator[CocircularGroup]:
+    """
+    The function `cocircular_groups` streams every maximal set of at least `min_size` points
+    (default: quadruples and larger) that lie on a common circle.
+
+    :param points: The input points as `(x, y)` pairs of `int`, `Fraction` or `float`; floats
+        are converted exactly to `Fraction`
+    :type points: Sequence[Sequence]
+    :param min_size: The minimum number of points in a reported group (at least 3)
+    :type min_size: int
+    :param processes: The number of worker processes. With `None` or 1 the search runs in the
+        calling process; otherwise the anchors are partitioned over a process pool
+    :type processes: Optional[int]
+    :return: an iterator of `CocircularGroup`, ordered by the smallest member index.
+        `min_size` counts distinct points; the indices of coincident copies of a member are
+        all included in its group.
+
+    Example:
+        >>> pts = [(1, 0), (0, 1), (-1, 0), (0, -1), (0, 0), (1, 0)]
+        >>> [g.indices for g in cocircular_groups(pts)]
+        [(0, 1, 2, 3, 5)]
+    """
+    if min_size < 3:
+        raise ValueError("min_size must be at least 3")
+    copies: Dict[Point, List[int]] = {}
+    for index, point in enumerate(_exact(points)):
+        copies.setdefault(point, []).append(index)
+    if all(len(indices) == 1 for indices in copies.values()):
+        yield from _distinct_groups(list(copies), min_size, processes)
+        return
+    # the distinct points are in order of first occurrence, so the groups stay ordered
+    owners = list(copies.values())
+    for group in _distinct_groups(list(copies), min_size, processes):
+        indices = sorted(i for k in group.indices for i in owners[k])
+        yield group._replace(indices=tuple(indices))
+
+
+def _distinct_groups(
+    exact: List[Point], min_size: int, processes: Optional[int]
+) -> Iterator[CocircularGroup]:
+    """The groups of pairwise distinct points"""
+    anchors = range(max(len(exact) - min_size + 1, 0))
+    if processes is None or processes <= 1:
+        for i in anchors:
+            yield from _anchor_groups(exact, i, min_size)
+        return
+    # anchor i costs O((N - i)^2), so small chunks keep the partitions balanced
+    chunksize = max(1, len(anchors) // (8 * processes))
+    with ProcessPoolExecutor(
+        processes, initializer=_init_worker, initargs=(exact,)
+    ) as pool:
+        tasks = ((i, min_size) for i in anchors)
+        for groups in pool.map(_worker_groups, tasks, chunksize=chunksize):
+            yield from groups
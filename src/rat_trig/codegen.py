@@ -0,0 +1,265 @@
+"""
+Native kernels generated from expression graphs.
+
+`generate_c` translates formulas built with `rat_trig.expr` into a C function that evaluates
+them over whole columns for one fixed numeric type, and `compile_native` builds it into a
+shared object with the system C compiler and loads it with `ctypes`. Shared objects are cached
+on disk by a hash of the generated source (which determines formula and type) and of the
+compiler, so each (formula, type) pair is compiled only once per machine.
+
+Two types are supported:
+
+- `"double"`: IEEE binary64, with `+`, `-`, `*` and `/`;
+- `"int64"`: signed 64-bit integers, polynomial formulas only. Every operation is checked
+  with the GCC/Clang overflow builtins, and an overflowing row raises `OverflowError` instead
+  of returning a wrong value.
+
+The compiler is `$CC` (default `cc`) and the cache directory is `$RAT_TRIG_CACHE` (default
+`~/.cache/rat_trig`).
+"""
+
+import ctypes
+import hashlib
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+from array import array
+from fractions import Fraction
+from pathlib import Path
+from typing import Dict, Mapping, Optional, Sequence, Union
+
+from .expr import Expr, Program
+
+Number = Union[int, Fraction, float]
+
+_TYPES = {
+    # name: (C type, array typecode, ctypes type)
+    "double": ("double", "d", ctypes.c_double),
+    "int64": ("int64_t", "q", ctypes.c_int64),
+}
+_BUILTINS = {
+    "+": "__builtin_add_overflow",
+    "-": "__builtin_sub_overflow",
+    "*": "__builtin_mul_overflow",
+}
+
+
+def _literal(value: Number, ctype: str) -> str:
+    if ctype == "int64":
+        if type(value) is not int or not -(2**63) <= value < 2**63:
+            raise ValueError(f"constant {value!r} is not an int64")
+        # the literal 9223372036854775808 does not fit, so its negation is not a constant
+        return "INT64_MIN" if value == -(2**63) else f"INT64_C({value})"
+    try:
+        number = float(value)
+    except OverflowError:
+        raise ValueError(f"constant {value!r} is out of range for double") from None
+    if number != number:
+        return "NAN"
+    if number in (math.inf, -math.inf):
+        return "INFINITY" if number > 0 else "(-INFINITY)"
+    return repr(number)
+
+
+def generate_c(outputs: Mapping[str, Expr], ctype: str = "double") -> str:
+    """
+    The function `generate_c` generates the C source of a column kernel.
+
+    The kernel is `int64_t rt_kernel(int64_t n, const T *c0, ..., T *o0, ...)` with the input
+    columns in the order of the sorted variable names followed by the output columns. It
+    returns -1 on success, or the index of the first row whose evaluation overflowed.
+
+    :param outputs: The formulas, by output name
+    :type outputs: Mapping[str, Expr]
+    :param ctype: The numeric type, `"double"` or `"int64"`
+    :type ctype: str
+    :return: the C source
+    """
+    if ctype not in _TYPES:
+        raise ValueError(f"unsupported type {ctype!r}")
+    c_name = _TYPES[ctype][0]
+    prog = Program(outputs)
+    names: Dict[int, str] = {}
+    body = []
+    for node in prog.nodes:
+        if node.op == "var":
+            names[node.serial] = f"c{prog.variables.index(node.value)}[i]"
+            continue
+        if node.op == "const":
+            names[node.serial] = _literal(node.value[1], ctype)
+            continue
+        name = f"t{len(body)}"
+        args = [names[a.serial] for a in node.args]
+        if node.op == "neg":
+            if ctype == "int64":
+                stmt = f"if (__builtin_sub_overflow(INT64_C(0), {args[0]}, &{name})) return i;"
+                body.append(f"{c_name} {name}; {stmt}")
+            else:
+                body.append(f"{c_name} {name} = -{args[0]};")
+        elif ctype == "int64":
+            if node.op not in _BUILTINS:
+                raise ValueError(f"operation {node.op!r} is not supported for int64")
+            stmt = f"if ({_BUILTINS[node.op]}({args[0]}, {args[1]}, &{name})) return i;"
+            body.append(f"{c_name} {name}; {stmt}")
+        else:
+            body.append(f"{c_name} {name} = {args[0]} {node.op} {args[1]};")
+        names[node.serial] = name
+    params = [f"const {c_name} *restrict c{i}" for i in range(len(prog.variables))]
+    params += [f"{c_name} *restrict o{i}" for i in range(len(prog.outputs))]
+    lines = [
+        "/* generated by rat_trig.codegen */",
+        "#include <math.h>",
+        "#include <stdint.h>",
+        "",
+        f"int64_t rt_kernel(int64_t n, {', '.join(params)})",
+        "{",
+        "    for (int64_t i = 0; i < n; ++i) {",
+    ]
+    lines += [f"        {stmt}" for stmt in body]
+    lines += [
+        f"        o{k}[i] = {names[node.serial]};"
+        for k, node in enumerate(prog.outputs.values())
+    ]
+    lines += ["    }", "    return -1;", "}", ""]
+    return "\n".join(lines)
+
+
+def _cache_dir() -> Path:
+    default = Path.home() / ".cache" / "rat_trig"
+    return Path(os.environ.get("RAT_TRIG_CACHE", default))
+
+
+def build_shared_object(source: str, cache_dir: Optional[Path] = None) -> Path:
+    """
+    The function `build_shared_object` compiles C source into a cached shared object.
+
+    :param source: The C source
+    :type source: str
+    :param cache_dir: The cache directory, by default `$RAT_TRIG_CACHE`
+    :type cache_dir: Optional[Path]
+    :raises RuntimeError: if no C compiler is available or compilation fails
+    :return: the path of the shared object
+    """
+    compiler = os.environ.get("CC", "cc")
+    if shutil.which(compiler) is None:
+        raise RuntimeError(f"C compiler {compiler!r} not found")
+    directory = Path(cache_dir) if cache_dir is not None else _cache_dir()
+    digest = hashlib.sha256(
+        f"{compiler}\0{sys.platform}\0{source}".encode()
+    ).hexdigest()
+    target = directory / f"rt_{digest[:32]}.so"
+    if target.exists():
+        return target
+    directory.mkdir(parents=True, exist_ok=True)
+    with tempfile.TemporaryDirectory(dir=directory) as tmp:
+        src = Path(tmp) / "kernel.c"
+        src.write_text(source)
+        out = Path(tmp) / target.name
+        cmd = [
+            compiler,
+            "-O2",
+            "-std=c99",
+            "-shared",
+            "-fPIC",
+            "-o",
+            str(out),
+            str(src),
+        ]
+        result = subprocess.run(cmd, capture_output=True, text=True)
+        if result.returncode != 0:
+            raise RuntimeError(f"compilation failed:\n{result.stderr}")
+        os.replace(
+            out, target
+        )  # atomic, so concurrent builders never see a partial file
+    return target
+
+
+class NativeKernel:
+    """A compiled column kernel, called like `rat_trig.expr.Program`"""
+
+    def __init__(
+        self, outputs: Mapping[str, Expr], ctype: str = "double", cache_dir=None
+    ) -> None:
+        """
+        :param outputs: The formulas, by output name
+        :type outputs: Mapping[str, Expr]
+        :param ctype: The numeric type, `"double"` or `"int64"`
+        :type ctype: str
+        :param cache_dir: The cache directory, by default `$RAT_TRIG_CACHE`
+        """
+        self.source = generate_c(outputs, ctype)
+        self.ctype = ctype
+        self.outputs = list(outputs)
+        self.variables = Program(outputs).variables
+        self.path = build_shared_object(self.source, cache_dir)
+        self._lib = ctypes.CDLL(str(self.path))
+        self._func = self._lib.rt_kernel
+        pointer = ctypes.POINTER(_TYPES[ctype][2])
+        count = len(self.variables) + len(self.outputs)
+        self._func.argtypes = [ctypes.c_int64] + [pointer] * count
+        self._func.restype = ctypes.c_int64
+
+    def __call__(self, **columns: Sequence[Number]) -> Dict[str, array]:
+        """
+        Evaluate all outputs over columns of inputs.
+
+        :param columns: One sequence per variable, by name, of equal length
+        :raises OverflowError: if an int64 operation overflows
+        :return: one `array` of results per output, by name
+        """
+        missing = set(self.variables) - set(columns)
+        if missing:  # the same error as `rat_trig.expr.Program`
+            raise TypeError(f"missing input columns: {', '.join(sorted(missing))}")
+        _, code, c_type = _TYPES[self.ctype]
+        inputs = [
+            (
+                c
+                if isinstance(c, array) and c.typecode == code
+                else array(code, columns[v])
+            )
+            for v, c in ((v, columns[v]) for v in self.variables)
+        ]
+        n = len(inputs[0]) if inputs else 0
+        if any(len(c) != n for c in inputs):
+            raise ValueError("input columns differ in length")
+        results = [array(code, bytes(n * array(code).itemsize)) for _ in self.outputs]
+        pointer = ctypes.POINTER(c_type)
+
+        def address(buf: array):
+            return ctypes.cast(buf.buffer_info()[0], pointer)
+
+        row = self._func(n, *(address(c) for c in inputs + results))
+        if row >= 0:
+            raise OverflowError(f"int64 overflow in row {row}")
+        return dict(zip(self.outputs, results))
+
+
+def compile_native(
+    outputs: Mapping[str, Expr],
+    ctype: str = "double",
+    fallback: bool = True,
+    cache_dir=None,
+):
+    """
+    The function `compile_native` compiles formulas to a native kernel for one numeric type.
+
+    :param outputs: The formulas, by output name
+    :type outputs: Mapping[str, Expr]
+    :param ctype: The numeric type, `"double"` or `"int64"`
+    :type ctype: str
+    :param fallback: Return the interpreted `Program` instead of failing when no C compiler
+        is available
+    :type fallback: bool
+    :param cache_dir: The cache directory, by default `$RAT_TRIG_CACHE`
+    :return: a `NativeKernel`, or a `Program` as fallback; both are called with one input
+        column per variable
+    """
+    try:
+        return NativeKernel(outputs, ctype, cache_dir)
+    except RuntimeError:
+        if not fallback:
+            raise
+        return Program(outputs)
@@ -0,0 +1,271 @@
+"""
+Collision detection for circular bodies with exact quadrance comparisons.
+
+Two circles overlap exactly when the quadrance between their centres does not exceed the
+square of the sum of their radii, and a circle meets a segment exactly when the quadrance from
+its centre to the segment does not exceed the squared radius. Both tests only use ring
+operations, so they are exact for `int` and `Fraction` coordinates and need no square root.
+
+`UniformGrid` is the broad phase. Bodies are kept in structure-of-arrays form (`xs`, `ys`,
+`radii`, owned by the caller and updated in place between frames); the grid remembers the
+cell span of each body so that `update` re-bins only the bodies that moved to other cells.
+"""
+
+from typing import (
+    Dict,
+    Iterable,
+    Iterator,
+    List,
+    MutableSequence,
+    Sequence,
+    Set,
+    Tuple,
+    Union,
+)
+from fractions import Fraction
+
+Number = Union[int, Fraction, float]
+Point = Tuple[Number, Number]
+Span = Tuple[int, int, int, int]  # first/last cell column, first/last cell row
+
+
+def circles_overlap(c_1: Point, r_1: Number, c_2: Point, r_2: Number) -> bool:
+    r"""
+    The function `circles_overlap` tests whether two closed discs intersect.
+
+    :param c_1: The centre of the first disc
+    :type c_1: Point
+    :param r_1: The radius of the first disc
+    :type r_1: Number
+    :param c_2: The centre of the second disc
+    :type c_2: Point
+    :param r_2: The radius of the second disc
+    :type r_2: Number
+    :return: whether the quadrance between the centres is at most \((r_1 + r_2)^2\)
+
+    Example:
+        >>> circles_overlap((0, 0), 1, (3, 4), 4)
+        True
+        >>> circles_overlap((0, 0), 1, (3, 4), Fraction(39, 10))
+        False
+    """
+    dx, dy = c_1[0] - c_2[0], c_1[1] - c_2[1]
+    return dx * dx + dy * dy <= (r_1 + r_2) * (r_1 + r_2)
+
+
+def circle_segment_overlap(c: Point, r: Number, a: Point, b: Point) -> bool:
+    r"""
+    The function `circle_segment_overlap` tests whether a closed disc meets a segment.
+
+    When the foot of the perpendicular from the centre falls inside the segment, the quadrance
+    to the segment is \(\text{cross}^2 / Q(a, b)\), and the comparison with \(r^2\) is done
+    after multiplying through by \(Q(a, b)\); otherwise the nearer endpoint decides.
+
+    :param c: The centre of the disc
+    :type c: Point
+    :param r: The radius of the disc
+    :type r: Number
+    :param a: The first endpoint of the segment
+    :type a: Point
+    :param b: The second endpoint of the segment
+    :type b: Point
+    :return: whether the disc and the segment have a common point
+
+    Example:
+        >>> circle_segment_overlap((1, 1), 1, (-5, 0), (5, 0))
+        True
+        >>> circle_segment_overlap((7, 1), 1, (-5, 0), (5, 0))
+        False
+    """
+    dx, dy = b[0] - a[0], b[1] - a[1]
+    wx, wy = c[0] - a[0], c[1] - a[1]
+    r2 = r * r
+    dot = wx * dx + wy * dy
+    if dot <= 0:
+        return wx * wx + wy * wy <= r2
+    q = dx * dx + dy * dy
+    if dot >= q:
+        vx, vy = c[0] - b[0], c[1] - b[1]
+        return vx * vx + vy * vy <= r2
+    cross = dx * wy - dy * wx
+    return cross * cross <= r2 * q
+
+
+def segment_cells(a: Point, b: Point, cell_size: Number) -> Iterator[Tuple[int, int]]:
+    """
+    The function `segment_cells` walks the grid cells that a segment passes through, column
+    by column: in each column the segment covers an interval of `y`, whose cells are the
+    ones it crosses. This visits O(number of crossed cells) cells, where the bounding box of a
+    long diagonal segment has O(length^2). Cells that the segment only touches at a boundary
+    are included, so every point of the segment lies in a visited cell. With `int` and
+    `Fraction` coordinates the walk is exact.
+
+    :param a: The first endpoint
+    :type a: Point
+    :param b: The second endpoint
+    :type b: Point
+    :param cell_size: The edge length of a cell
+    :type cell_size: Number
+    :return: an iterator of the `(column, row)` cells
+
+    Example:
+        >>> list(segment_cells((1, 1), (7, 3), 4))
+        [(0, 0), (1, 0)]
+        >>> len(list(segment_cells((0, 0), (1000, 999), 1)))
+        2000
+    """
+    (x_0, y_0), (x_1, y_1) = (a, b) if a[0] <= b[0] else (b, a)
+    dx, dy = x_1 - x_0, y_1 - y_0
+    if not isinstance(dx, float):
+        dx = Fraction(dx)  # exact slopes for int and Fraction coordinates
+    for cx in range(int(x_0 // cell_size), int(x_1 // cell_size) + 1):
+        if dx:
+            lo = max(x_0, cx * cell_size) - x_0
+            hi = min(x_1, (cx + 1) * cell_size) - x_0
+            y_a, y_b = y_0 + lo * dy / dx, y_0 + hi * dy / dx
+        else:
+            y_a, y_b = y_0, y_1
+        if y_a > y_b:
+            y_a, y_b = y_b, y_a
+        for cy in range(int(y_a // cell_size), int(y_b // cell_size) + 1):
+            yield cx, cy
+
+
+class UniformGrid:
+    """
+    Uniform-grid broad phase over bodies stored as structure of arrays.
+
+    Example:
+        >>> xs, ys, radii = [0, 3, 20], [0, 0, 0], [2, 2, 1]
+        >>> grid = UniformGrid(4, xs, ys, radii)
+        >>> grid.overlapping_pairs()
+        [(0, 1)]
+        >>> xs[2] = 4
+        >>> grid.update([2])
+        >>> grid.overlapping_pairs()
+        [(0, 1), (1, 2)]
+    """
+
+    def __init__(
+        self,
+        cell_size: Number,
+        xs: MutableSequence[Number],
+        ys: MutableSequence[Number],
+        radii: Sequence[Number],
+    ) -> None:
+        """
+        :param cell_size: The edge length of a grid cell, typically about the largest diameter
+        :type cell_size: Number
+        :param xs: The x-coordinates of the body centres
+        :type xs: MutableSequence[Number]
+        :param ys: The y-coordinates of the body centres
+        :type ys: MutableSequence[Number]
+        :param radii: The body radii
+        :type radii: Sequence[Number]
+        """
+        if cell_size <= 0:
+            raise ValueError("cell_size must be positive")
+        self.cell_size = cell_size
+        self.xs, self.ys, self.radii = xs, ys, radii
+        self._cells: Dict[Tuple[int, int], Set[int]] = {}
+        self._spans: List[Span] = []
+        self.update(range(len(xs)))
+
+    def _span(self, i: int) -> Span:
+        x, y, r, cell = self.xs[i], self.ys[i], self.radii[i], self.cell_size
+        return (
+            int((x - r) // cell),
+            int((x + r) // cell),
+            int((y - r) // cell),
+            int((y + r) // cell),
+        )
+
+    def _bin(self, i: int, span: Span, insert: bool) -> None:
+        cells = self._cells
+        for cx in range(span[0], span[1] + 1):
+            for cy in range(span[2], span[3] + 1):
+                if insert:
+                    cells.setdefault((cx, cy), set()).add(i)
+                else:
+                    members = cells[cx, cy]
+                    members.discard(i)
+                    if not members:
+                        del cells[cx, cy]
+
+    def update(self, moved: Iterable[int]) -> None:
+        """
+        Re-bin the given bodies after their positions or radii changed. Bodies whose cell span
+        is unchanged cost a single span computation. Indices past the end register new bodies
+        appended to the arrays.
+
+        :param moved: The indices of the bodies that moved
+        :type moved: Iterable[int]
+        """
+        spans = self._spans
+        for i in sorted(moved):
+            span = self._span(i)
+            if i < len(spans):
+                if spans[i] == span:
+                    continue
+                self._bin(i, spans[i], False)
+                spans[i] = span
+            else:
+                spans.extend([(0, -1, 0, -1)] * (i + 1 - len(spans)))
+                spans[i] = span
+            self._bin(i, span, True)
+
+    def candidate_pairs(self) -> List[Tuple[int, int]]:
+        """
+        Pairs of bodies sharing at least one cell, each reported once (in the first cell of the
+        intersection of their spans).
+
+        :return: the pairs `(i, j)` with `i < j`, sorted
+        """
+        spans = self._spans
+        pairs = []
+        for (cx, cy), members in self._cells.items():
+            if len(members) < 2:
+                continue
+            ordered = sorted(members)
+            for n, i in enumerate(ordered):
+                si = spans[i]
+                for j in ordered[n + 1 :]:
+                    sj = spans[j]
+                    if cx == max(si[0], sj[0]) and cy == max(si[2], sj[2]):
+                        pairs.append((i, j))
+        pairs.sort()
+        return pairs
+
+    def overlapping_pairs(self) -> List[Tuple[int, int]]:
+        """
+        The candidate pairs that pass the exact narrow-phase test `circles_overlap`.
+
+        :return: the pairs `(i, j)` with `i < j`, sorted
+        """
+        xs, ys, radii = self.xs, self.ys, self.radii
+        return [
+            (i, j)
+            for i, j in self.candidate_pairs()
+            if circles_overlap((xs[i], ys[i]), radii[i], (xs[j], ys[j]), radii[j])
+        ]
+
+    def query_segment(self, a: Point, b: Point) -> List[int]:
+        """
+        The bodies meeting the segment from `a` to `b`, e.g. a static wall.
+
+        :param a: The first endpoint
+        :type a: Point
+        :param b: The second endpoint
+        :type b: Point
+        :return: the sorted indices of the bodies passing `circle_segment_overlap`
+        """
+        cells = self._cells
+        candidates: Set[int] = set()
+        for key in segment_cells(a, b, self.cell_size):
+            candidates.update(cells.get(key, ()))
+        xs, ys, radii = self.xs, self.ys, self.radii
+        return sorted(
+            i
+            for i in candidates
+            if circle_segment_overlap((xs[i], ys[i]), radii[i], a, b)
+        )
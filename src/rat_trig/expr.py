@@ -0,0 +1,262 @@
+"""
+Expression graphs for compound rational-trigonometry formulas.
+
+Formulas are written once with symbolic variables, using the ordinary functions of this
+package: `archimedes(var("q_1"), var("q_2"), var("q_3"))` builds an expression instead of a
+number. Nodes are hash-consed, so a subexpression such as `q_1 + q_2 - q_3` that occurs in
+several formulas is a single node of the resulting DAG. `compile_exprs` orders the DAG once
+and generates one straight-line Python function that evaluates every node exactly once per
+row, in a single fused pass over the input columns.
+
+Evaluation uses the plain Python operators on the input values, so the results are exactly
+those of evaluating the formulas directly on `int`, `Fraction` or `float` inputs (in
+particular `/` of two `int` gives a `float`; pass `Fraction` inputs for exact quotients).
+"""
+
+import functools
+import itertools
+import math
+import weakref
+from fractions import Fraction
+from typing import Callable, Dict, List, Mapping, Sequence, Tuple, Union
+
+from . import instrument
+
+Number = Union[int, Fraction, float]
+Operand = Union["Expr", Number]
+
+_COMMUTATIVE = ("+", "*")
+_SERIAL = itertools.count()
+_NODES: "weakref.WeakValueDictionary[tuple, Expr]" = weakref.WeakValueDictionary()
+
+
+class Expr:
+    """
+    A node of an expression DAG. Use `var` and `const` to create leaves.
+
+    Example:
+        >>> a, b = var("a"), var("b")
+        >>> (a + b) * (b + a) is (b + a) * (a + b)
+        True
+    """
+
+    __slots__ = ("op", "args", "value", "serial", "__weakref__")
+
+    def __init__(self, op: str, args: Tuple["Expr", ...], value) -> None:
+        self.op, self.args, self.value = op, args, value
+        self.serial = next(_SERIAL)
+
+    @staticmethod
+    def make(op: str, args: Tuple["Expr", ...] = (), value=None) -> "Expr":
+        """The unique node with the given operation, operands and leaf value"""
+        if op in _COMMUTATIVE:
+            args = tuple(sorted(args, key=lambda e: e.serial))
+        if op == "const" and value[0] == "float":
+            # -0.0 == 0.0, but 1 / x and copysign tell them apart
+            key = (op, (), (*value, math.copysign(1.0, value[1])))
+        else:
+            key = (op, tuple(a.serial for a in args), value)
+        node = _NODES.get(key)
+        if node is None:
+            node = Expr(op, args, value)
+            _NODES[key] = node
+        return node
+
+    def __reduce__(self):
+        # unpickled nodes are hash-consed again, with serials of the receiving process
+        return _node, (self.op, self.args, self.value)
+
+    def __repr__(self) -> str:
+        if self.op == "var":
+            return str(self.value)
+        if self.op == "const":
+            return repr(self.value)
+        if self.op == "neg":
+            return f"(-{self.args[0]!r})"
+        return f"({self.args[0]!r} {self.op} {self.args[1]!r})"
+
+    def __add__(self, other: Operand) -> "Expr":
+        return Expr.make("+", (self, _lift(other)))
+
+    def __radd__(self, other: Operand) -> "Expr":
+        return Expr.make("+", (_lift(other), self))
+
+    def __sub__(self, other: Operand) -> "Expr":
+        return Expr.make("-", (self, _lift(other)))
+
+    def __rsub__(self, other: Operand) -> "Expr":
+        return Expr.make("-", (_lift(other), self))
+
+    def __mul__(self, other: Operand) -> "Expr":
+        return Expr.make("*", (self, _lift(other)))
+
+    def __rmul__(self, other: Operand) -> "Expr":
+        return Expr.make("*", (_lift(other), self))
+
+    def __truediv__(self, other: Operand) -> "Expr":
+        return Expr.make("/", (self, _lift(other)))
+
+    def __rtruediv__(self, other: Operand) -> "Expr":
+        return Expr.make("/", (_lift(other), self))
+
+    def __neg__(self) -> "Expr":
+        return Expr.make("neg", (self,))
+
+    def __pow__(self, exponent: int) -> "Expr":
+        if not isinstance(exponent, int) or exponent < 1:
+            return NotImplemented
+        if exponent == 1:
+            return self
+        half = self ** (exponent // 2)
+        square = half * half
+        return square * self if exponent % 2 else square
+
+
+def _node(op: str, args: Tuple[Expr, ...], value) -> Expr:
+    return Expr.make(op, args, value)
+
+
+def var(name: str) -> Expr:
+    """A named input variable"""
+    return Expr.make("var", value=name)
+
+
+def const(value: Number) -> Expr:
+    """A constant; constants of different types are different nodes"""
+    return Expr.make("const", value=(type(value).__name__, value))
+
+
+def _lift(value: Operand) -> Expr:
+    if isinstance(value, Expr):
+        return value
+    if isinstance(value, (int, Fraction, float)):
+        return const(value)
+    raise TypeError(f"cannot use {type(value).__name__} in an expression")
+
+
+class Program:
+    """A compiled set of formulas, evaluated in one fused pass"""
+
+    def __init__(self, outputs: Mapping[str, Expr]) -> None:
+        self.outputs = dict(outputs)
+        order: List[Expr] = []
+        seen = set()
+
+        def visit(node: Expr) -> None:
+            # iterative post-order, since formula chains can be deep
+            stack = [(node, False)]
+            while stack:
+                current, expanded = stack.pop()
+                if current.serial in seen:
+                    continue
+                if expanded or not current.args:
+                    seen.add(current.serial)
+                    order.append(current)
+                    continue
+                stack.append((current, True))
+                stack.extend((a, False) for a in reversed(current.args))
+
+        for node in self.outputs.values():
+            visit(node)
+        self.nodes = order
+        self.variables = sorted(n.value for n in order if n.op == "var")
+        if not self.variables:
+            # the number of rows comes from the input columns
+            raise ValueError("the formulas must use at least one variable")
+        self._kernel = self._generate()
+        if instrument.ENABLED:
+            self._kernel = instrument.instrument_kernel(self._kernel, self.outputs)
+
+    def __reduce__(self):
+        # the kernel is generated code, so a copy compiles the formulas again
+        return _program, (tuple(self.outputs.items()),)
+
+    @property
+    def size(self) -> int:
+        """The number of operations evaluated per row, after sharing subexpressions"""
+        return sum(1 for n in self.nodes if n.args)
+
+    def _generate(self) -> Callable:
+        names: Dict[int, str] = {}
+        consts: Dict[str, Number] = {}
+        body = []
+        for node in self.nodes:
+            if node.op == "var":
+                names[node.serial] = f"v{self.variables.index(node.value)}"
+            elif node.op == "const":
+                name = f"k{len(consts)}"
+                consts[name] = node.value[1]
+                names[node.serial] = name
+            else:
+                name = f"t{len(body)}"
+                args = [names[a.serial] for a in node.args]
+                if node.op == "neg":
+                    body.append(f"{name} = -{args[0]}")
+                else:
+                    body.append(f"{name} = {args[0]} {node.op} {args[1]}")
+                names[node.serial] = name
+        columns = ", ".join(f"c{i}" for i in range(len(self.variables)))
+        row = ", ".join(f"v{i}" for i in range(len(self.variables)))
+        outs = [names[node.serial] for node in self.outputs.values()]
+        lines = [f"def _kernel({columns}):"]
+        lines += [f"    o{i} = []; a{i} = o{i}.append" for i in range(len(outs))]
+        lines += [f"    for {row}, in zip({columns}):"]
+        lines += [f"        {stmt}" for stmt in body]
+        lines += [f"        a{i}({out})" for i, out in enumerate(outs)]
+        lines += ["    return " + "".join(f"o{i}, " for i in range(len(outs)))]
+        namespace: dict = dict(consts)
+        exec(compile("\n".join(lines), "<rat_trig.expr>", "exec"), namespace)
+        return namespace["_kernel"]
+
+    def __call__(self, **columns: Sequence[Number]) -> Dict[str, List[Number]]:
+        """
+        Evaluate all outputs over columns of inputs.
+
+        :param columns: One sequence per variable, by name
+        :return: one list of results per output, by name
+        """
+        missing = set(self.variables) - set(columns)
+        if missing:
+            raise TypeError(f"missing input columns: {', '.join(sorted(missing))}")
+        results = self._kernel(*(columns[v] for v in self.variables))
+        return dict(zip(self.outputs, results))
+
+    def evaluate(self, **values: Number) -> Dict[str, Number]:
+        """Evaluate all outputs for a single row of scalar inputs"""
+        results = self(**{k: (v,) for k, v in values.items()})
+        return {k: v[0] for k, v in results.items()}
+
+
+@functools.lru_cache(maxsize=32)
+def _program(outputs: Tuple[Tuple[str, Expr], ...]) -> Program:
+    """
+    The program of unpickled formulas. A pool worker receives the program with every task,
+    and the cache keeps the nodes alive, so it compiles the same formulas only once.
+    """
+    return Program(dict(outputs))
+
+
+def compile_exprs(outputs: Mapping[str, Expr]) -> Program:
+    """
+    The function `compile_exprs` compiles named formulas into a `Program`.
+
+    :param outputs: The formulas to evaluate, by output name
+    :type outputs: Mapping[str, Expr]
+    :return: the program; call it with one input column per variable
+    :raises ValueError: if the formulas use no variables
+
+    Example:
+        >>> from rat_trig.trigonom import archimedes
+        >>> q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+        >>> quadrea = archimedes(q_1, q_2, q_3)
+        >>> prog = compile_exprs({
+        ...     "quadrea": quadrea,
+        ...     "spread_3": quadrea / (4 * q_1 * q_2),
+        ...     "circumquadrance": q_1 * q_2 * q_3 / quadrea,
+        ... })
+        >>> prog.size
+        10
+        >>> prog(q_1=[Fraction(1, 2)], q_2=[Fraction(1, 4)], q_3=[Fraction(1, 6)])
+        {'quadrea': [Fraction(23, 144)], 'spread_3': [Fraction(23, 72)], 'circumquadrance': [Fraction(3, 23)]}
+    """
+    return Program(outputs)
@@ -0,0 +1,183 @@
+"""
+Bulk formatting of result columns as text.
+
+`str()` of a `Fraction` runs a Python-level method per value, and `csv.writer` adds a call per
+row. The functions of this module format whole columns at once. Integer columns go through
+`map(str, ...)` in C, and `Fraction` columns read the numerator and denominator once per
+value. The fields and separators of a chunk are laid out in one list of known size, joined
+into one string, whose size `str.join` computes before it copies anything, and written with a
+single `write` call.
+
+Three styles are supported:
+
+- `"fraction"`: exact `p/q`, or `p` for integers, like `str`;
+- `"decimal"`: rounded half to even to a fixed number of digits after the point;
+- `"scientific"`: rounded half to even to a fixed number of digits after the point of a
+  mantissa in `[1, 10)`, like the `e` format of `float`.
+
+Rational values are rounded exactly, so the digits never depend on float conversion.
+"""
+
+import operator
+from fractions import Fraction
+from itertools import repeat
+from typing import Iterable, List, Sequence, TextIO, Tuple, Union
+
+STYLES = ("fraction", "decimal", "scientific")
+
+Number = Union[int, Fraction, float]
+
+
+def _getters(slots: Tuple[str, str] = ("_numerator", "_denominator")) -> Tuple:
+    """
+    Getters of the numerator and denominator slots of `Fraction`, which skip the property
+    calls, if this Python version has them, and otherwise of the public properties.
+    """
+    getters = tuple(map(operator.attrgetter, slots))
+    probe = Fraction(-3, 4)
+    try:
+        if tuple(get(probe) for get in getters) == (-3, 4):
+            return getters
+    except AttributeError:
+        pass
+    return operator.attrgetter("numerator"), operator.attrgetter("denominator")
+
+
+_NUMERATOR, _DENOMINATOR = _getters()
+
+
+def _round_div(num: int, den: int) -> int:
+    """`num / den` rounded half to even, for `num >= 0` and `den > 0`"""
+    quot, rem = divmod(num, den)
+    twice = 2 * rem
+    if twice > den or (twice == den and quot & 1):
+        quot += 1
+    return quot
+
+
+def _decimal(num: int, den: int, digits: int) -> str:
+    scaled = _round_div(abs(num) * 10**digits, den)
+    sign = "-" if num < 0 and scaled else ""
+    if not digits:
+        return f"{sign}{scaled}"
+    text = str(scaled).rjust(digits + 1, "0")
+    return f"{sign}{text[:-digits]}.{text[-digits:]}"
+
+
+def _scientific(num: int, den: int, digits: int) -> str:
+    if num == 0:
+        mantissa, exp = "0" * (digits + 1), 0
+    else:
+        size = abs(num)
+        exp = len(str(size)) - len(str(den))
+        if size * 10**-exp < den if exp < 0 else size < den * 10**exp:
+            exp -= 1  # now 10**exp <= size / den < 10**(exp + 1)
+        shift = digits - exp
+        if shift >= 0:
+            scaled = _round_div(size * 10**shift, den)
+        else:
+            scaled = _round_div(size, den * 10**-shift)
+        if scaled == 10 ** (digits + 1):  # rounded up to the next power of ten
+            scaled //= 10
+            exp += 1
+        mantissa = str(scaled)
+    point = f"{mantissa[0]}.{mantissa[1:]}" if digits else mantissa
+    sign = "-" if num < 0 else ""
+    return f"{sign}{point}e{'-' if exp < 0 else '+'}{abs(exp):02d}"
+
+
+def format_column(
+    values: Sequence[Number], style: str = "fraction", digits: int = 6
+) -> List[str]:
+    """
+    The function `format_column` formats a column of numbers.
+
+    :param values: `int`, `Fraction` or `float` values, all of one kind
+    :type values: Sequence[Number]
+    :param style: `"fraction"`, `"decimal"` or `"scientific"`
+    :type style: str
+    :param digits: The number of digits after the point for the other styles
+    :type digits: int
+    :return: the texts
+
+    Example:
+        >>> format_column([Fraction(1, 3), Fraction(-5, 2), Fraction(4)])
+        ['1/3', '-5/2', '4']
+        >>> format_column([Fraction(2, 3), Fraction(-1, 8), 7], "decimal", 2)
+        ['0.67', '-0.12', '7.00']
+        >>> format_column([Fraction(1, 3), 123456, Fraction(-999, 100000)], "scientific", 2)
+        ['3.33e-01', '1.23e+05', '-9.99e-03']
+    """
+    if style not in STYLES:
+        raise ValueError(f"unknown format {style!r}")
+    if digits < 0:
+        raise ValueError("digits must not be negative")
+    if not isinstance(values, list):
+        values = list(values)
+    if all(type(v) is int for v in values):
+        if style == "fraction":
+            return list(map(str, values))
+        if style == "decimal":
+            suffix = "." + "0" * digits if digits else ""
+            return [f"{v}{suffix}" for v in values]
+        return [_scientific(v, 1, digits) for v in values]
+    if any(isinstance(v, float) for v in values):
+        if style == "fraction":
+            return list(map(str, values))
+        spec = f".{digits}f" if style == "decimal" else f".{digits}e"
+        return list(map(format, values, repeat(spec)))
+    try:
+        nums = list(map(_NUMERATOR, values))
+        dens = list(map(_DENOMINATOR, values))
+    except AttributeError:  # ints mixed in
+        nums = list(map(operator.attrgetter("numerator"), values))
+        dens = list(map(operator.attrgetter("denominator"), values))
+    if style == "fraction":
+        return [f"{n}/{d}" if d != 1 else str(n) for n, d in zip(nums, dens)]
+    convert = _decimal if style == "decimal" else _scientific
+    return list(map(convert, nums, dens, repeat(digits)))
+
+
+def format_rows(
+    columns: Iterable[Sequence[Number]],
+    style: str = "fraction",
+    digits: int = 6,
+    delimiter: str = ",",
+) -> str:
+    """
+    The function `format_rows` formats columns of numbers as delimited rows of text.
+
+    :param columns: The columns, all of the same length
+    :param style: `"fraction"`, `"decimal"` or `"scientific"`
+    :type style: str
+    :param digits: The number of digits after the point for the other styles
+    :type digits: int
+    :param delimiter: The field separator
+    :type delimiter: str
+    :return: the rows, each ended by a newline
+
+    Example:
+        >>> format_rows([[1, 2], [Fraction(1, 2), Fraction(3, 4)]])
+        '1,1/2\\n2,3/4\\n'
+    """
+    texts = [format_column(col, style, digits) for col in columns]
+    if not texts or not texts[0]:
+        return ""
+    # one slot per field and per separator, filled by strided slice assignments
+    nrows, width = len(texts[0]), 2 * len(texts)
+    tokens = [delimiter] * (nrows * width)
+    for k, text in enumerate(texts):
+        tokens[2 * k :: width] = text
+    tokens[width - 1 :: width] = ["\n"] * nrows
+    return "".join(tokens)
+
+
+def write_rows(
+    out: TextIO,
+    columns: Iterable[Sequence[Number]],
+    style: str = "fraction",
+    digits: int = 6,
+    delimiter: str = ",",
+) -> None:
+    """The function `write_rows` writes `format_rows(...)` to a text stream"""
+    out.write(format_rows(columns, style, digits, delimiter))
@@ -0,0 +1,217 @@
+"""
+Opt-in bit-growth instrumentation for exact computations.
+
+The cost of `int` and `Fraction` arithmetic grows with the size of the operands. This module
+records the bit lengths of the numerators and denominators that go into and come out of a
+function, as one histogram per function and series (`in_num`, `in_den`, `out_num`,
+`out_den`). The histograms show which stage of a pipeline makes the numbers grow.
+
+There are two ways to turn it on:
+
+- Set the environment variable `RAT_TRIG_BITS` to a file name before `rat_trig` is
+  imported. Then `quadrance`, `archimedes` and `archimedes_batch` of `rat_trig.trigonom`
+  are instrumented, and so is every `rat_trig.expr.Program`: its input columns are recorded
+  once per call under the name `expr`, and the results of each formula under
+  `expr.<formula>`. The histograms are written to the file as JSON when the process exits.
+- Wrap a function explicitly with `instrumented`, which records into a given `BitRecorder`.
+
+If neither is used, nothing is wrapped and the functions run at full speed. Floats and other
+inexact values are not recorded, and a call that has nothing to record is not counted. For `LazyFraction`, the stored unreduced numerator and
+denominator are recorded, since those are what the arithmetic works on.
+"""
+
+import atexit
+import functools
+import json
+import os
+from array import array
+from collections import Counter
+from typing import Any, Callable, Dict, Iterable, List, MutableMapping, Optional, Tuple
+
+ENV_VAR = "RAT_TRIG_BITS"
+SERIES = ("in_num", "in_den", "out_num", "out_den")
+
+_COLUMN_TYPES = (list, tuple, array, memoryview)
+
+
+def _column(value: Any) -> Iterable:
+    return value if isinstance(value, _COLUMN_TYPES) else (value,)
+
+
+def _split(values: Iterable) -> Tuple[List[int], List[int]]:
+    """The numerators and denominators of the exact values"""
+    nums: List[int] = []
+    dens: List[int] = []
+    for v in values:
+        if isinstance(v, int):
+            nums.append(v)
+            dens.append(1)
+        elif hasattr(v, "_den"):  # LazyFraction, without forcing a reduction
+            nums.append(v._num)
+            dens.append(v._den)
+        elif hasattr(v, "denominator"):
+            nums.append(v.numerator)
+            dens.append(v.denominator)
+    return nums, dens
+
+
+class BitRecorder:
+    """
+    Histograms of bit lengths, by function name and series.
+
+    Example:
+        >>> from fractions import Fraction
+        >>> recorder = BitRecorder()
+        >>> recorder.record("f", "in", [3, Fraction(1, 6)])
+        True
+        >>> recorder.histograms["f"]["in_num"], recorder.histograms["f"]["in_den"]
+        (Counter({2: 1, 1: 1}), Counter({1: 1, 3: 1}))
+    """
+
+    def __init__(self) -> None:
+        self.calls: Counter = Counter()
+        self.histograms: Dict[str, Dict[str, Counter]] = {}
+
+    def record(self, name: str, direction: str, values: Iterable) -> bool:
+        """
+        Add values to the histograms of a function.
+
+        :param name: The function name
+        :type name: str
+        :param direction: `"in"` for arguments, `"out"` for results
+        :type direction: str
+        :param values: The values; inexact values are skipped
+        :return: whether any value was recorded
+        """
+        nums, dens = _split(values)
+        if not nums:
+            return False  # only inexact values, e.g. expressions being built
+        series = self.histograms.setdefault(name, {s: Counter() for s in SERIES})
+        series[direction + "_num"].update(map(int.bit_length, nums))
+        series[direction + "_den"].update(map(int.bit_length, dens))
+        return True
+
+    def to_dict(self) -> Dict[str, Dict[str, Any]]:
+        """
+        The histograms with summary statistics, in a JSON-serializable form.
+
+        For each function: `calls`, and per series `count`, `max`, `mean` and `histogram`,
+        which maps bit lengths (as strings) to counts.
+        """
+        result: Dict[str, Dict[str, Any]] = {}
+        for name, series in sorted(self.histograms.items()):
+            entry: Dict[str, Any] = {"calls": self.calls[name]}
+            for key, hist in series.items():
+                count = sum(hist.values())
+                entry[key] = {
+                    "count": count,
+                    "max": max(hist, default=0),
+                    "mean": (
+                        sum(b * c for b, c in hist.items()) / count if count else 0.0
+                    ),
+                    "histogram": {str(b): hist[b] for b in sorted(hist)},
+                }
+            result[name] = entry
+        return result
+
+    def save(self, path) -> None:
+        """Write `to_dict()` to a JSON file"""
+        with open(path, "w") as stream:
+            json.dump(self.to_dict(), stream, indent=1)
+
+    def clear(self) -> None:
+        self.calls.clear()
+        self.histograms.clear()
+
+
+def instrumented(
+    func: Callable, name: Optional[str] = None, recorder: Optional[BitRecorder] = None
+) -> Callable:
+    """
+    The function `instrumented` wraps a function to record the bit lengths of its arguments
+    and results.
+
+    Arguments and results may be scalars or columns (`list`, `tuple`, `array`,
+    `memoryview`). A result that is a `dict` of columns, like that of a
+    `rat_trig.expr.Program`, is recorded under `name.<key>`.
+
+    :param func: The function
+    :param name: The name of its histograms, by default the qualified name of `func`
+    :param recorder: The recorder, by default `RECORDER`
+    :return: the wrapped function
+
+    Example:
+        >>> from rat_trig.trigonom import archimedes
+        >>> recorder = BitRecorder()
+        >>> f = instrumented(archimedes, "archimedes", recorder)
+        >>> f(2**40, 2**40, 2**40)
+        3626777458843887524118528
+        >>> recorder.to_dict()["archimedes"]["out_num"]["max"]
+        82
+    """
+    name = name or getattr(func, "__qualname__", repr(func))
+    if recorder is None:
+        recorder = RECORDER if RECORDER is not None else BitRecorder()
+
+    @functools.wraps(func)
+    def wrapper(*args, **kwargs):
+        recorded = False
+        for arg in (*args, *kwargs.values()):
+            recorded |= recorder.record(name, "in", _column(arg))
+        result = func(*args, **kwargs)
+        if isinstance(result, dict):
+            for key, column in result.items():
+                if recorder.record(f"{name}.{key}", "out", _column(column)):
+                    recorder.calls[f"{name}.{key}"] += 1
+        else:
+            recorded |= recorder.record(name, "out", _column(result))
+        if recorded:
+            recorder.calls[name] += 1
+        return result
+
+    wrapper.recorder = recorder  # type: ignore[attr-defined]
+    return wrapper
+
+
+def instrument_namespace(
+    namespace: MutableMapping[str, Any], names: Iterable[str], prefix: str
+) -> None:
+    """Replace functions of a module namespace by instrumented wrappers"""
+    for name in names:
+        namespace[name] = instrumented(namespace[name], f"{prefix}.{name}")
+
+
+def instrument_kernel(
+    kernel: Callable, outputs: Iterable[str], recorder: Optional[BitRecorder] = None
+) -> Callable:
+    """
+    Wrap the column kernel of a `rat_trig.expr.Program`, which takes the input columns and
+    returns one result column per output. The inputs are recorded once per call as `expr`,
+    like the arguments of a function wrapped by `instrumented`, and each output as
+    `expr.<name>`.
+    """
+    recorder = recorder if recorder is not None else RECORDER
+    names = [f"expr.{output}" for output in outputs]
+
+    @functools.wraps(kernel)
+    def wrapper(*columns):
+        recorded = False
+        for column in columns:
+            recorded |= recorder.record("expr", "in", _column(column))
+        if recorded:
+            recorder.calls["expr"] += 1
+        results = kernel(*columns)
+        for name, result in zip(names, results):
+            if recorder.record(name, "out", _column(result)):
+                recorder.calls[name] += 1
+        return results
+
+    return wrapper
+
+
+RECORDER: Optional[BitRecorder] = None
+ENABLED = bool(os.environ.get(ENV_VAR))
+
+if ENABLED:
+    RECORDER = BitRecorder()
+    atexit.register(RECORDER.save, os.environ[ENV_VAR])
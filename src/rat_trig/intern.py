@@ -0,0 +1,121 @@
+"""
+Interning and memoization for frequently reused rational quadrances.
+
+In grid-based workloads the same few quadrances occur over and over. An `InternPool` maps
+each `(numerator, denominator)` pair to one shared `Fraction`, so repeated values are
+constructed and hashed only once, and `memoized_archimedes` returns an `archimedes` with a
+bounded LRU cache keyed by the quadrance triple. Both are opt-in and report hit statistics,
+so whether they pay off can be judged on the actual workload.
+"""
+
+import functools
+from fractions import Fraction
+from typing import Callable, Dict, Iterable, List, NamedTuple, Optional, Tuple
+
+from .trigonom import archimedes
+
+
+class PoolStats(NamedTuple):
+    hits: int
+    misses: int
+    size: int
+
+    @property
+    def hit_rate(self) -> float:
+        return hit_rate(self)
+
+
+class InternPool:
+    """
+    A pool of shared `Fraction` objects keyed by numerator and denominator.
+
+    Example:
+        >>> pool = InternPool()
+        >>> pool.fraction(1, 2) is pool.fraction(2, 4) is pool.intern(Fraction(1, 2))
+        True
+        >>> pool.stats()
+        PoolStats(hits=1, misses=2, size=2)
+    """
+
+    def __init__(self, maxsize: Optional[int] = None) -> None:
+        """
+        :param maxsize: The maximum number of keys, at least 1, by default unbounded; once
+            full, the oldest keys are evicted first
+        :type maxsize: Optional[int]
+        """
+        if maxsize is not None and maxsize < 1:
+            raise ValueError("maxsize must be at least 1")
+        self.maxsize = maxsize
+        self._pool: Dict[Tuple[int, int], Fraction] = {}
+        self.hits = 0
+        self.misses = 0
+
+    def __len__(self) -> int:
+        return len(self._pool)
+
+    def _insert(self, key: Tuple[int, int], value: Fraction) -> None:
+        if self.maxsize is not None and len(self._pool) >= self.maxsize:
+            del self._pool[next(iter(self._pool))]
+        self._pool[key] = value
+
+    def fraction(self, numerator: int, denominator: int = 1) -> Fraction:
+        """The shared `Fraction` equal to `numerator / denominator`"""
+        key = (numerator, denominator)
+        value = self._pool.get(key)
+        if value is not None:
+            self.hits += 1
+            return value
+        self.misses += 1
+        value = Fraction(numerator, denominator)
+        canonical = (value.numerator, value.denominator)
+        if canonical != key:
+            # share the object with the reduced key, and remember the unreduced key too
+            shared = self._pool.get(canonical)
+            if shared is None:
+                self._insert(canonical, value)
+            else:
+                value = shared
+        self._insert(key, value)
+        return value
+
+    def intern(self, value: Fraction) -> Fraction:
+        """The shared `Fraction` equal to `value`"""
+        return self.fraction(value.numerator, value.denominator)
+
+    def intern_all(self, values: Iterable[Fraction]) -> List[Fraction]:
+        """The shared `Fraction` objects for a column of values"""
+        fraction = self.fraction
+        return [fraction(v.numerator, v.denominator) for v in values]
+
+    def stats(self) -> PoolStats:
+        return PoolStats(self.hits, self.misses, len(self._pool))
+
+    def clear(self) -> None:
+        self._pool.clear()
+        self.hits = self.misses = 0
+
+
+def memoized_archimedes(maxsize: Optional[int] = 4096) -> Callable:
+    """
+    The function `memoized_archimedes` returns `archimedes` wrapped in an LRU cache of
+    quadrance triples. Inputs of different types are cached separately, so the type of the
+    result is the same as without the cache.
+
+    :param maxsize: The maximum number of cached triples, `None` for unbounded
+    :type maxsize: Optional[int]
+    :return: the cached function, with `cache_info()` and `cache_clear()`
+
+    Example:
+        >>> quadrea = memoized_archimedes(maxsize=16)
+        >>> [quadrea(1, 2, 3) for _ in range(4)]
+        [8, 8, 8, 8]
+        >>> hit_rate(quadrea.cache_info())
+        0.75
+    """
+    return functools.lru_cache(maxsize=maxsize, typed=True)(archimedes)
+
+
+def hit_rate(info) -> float:
+    """The fraction of calls answered from a cache, given its `cache_info()` or `stats()`"""
+    total = info.hits + info.misses
+    return info.hits / total if total else 0.0
@@ -0,0 +1,324 @@
+"""
+Interval arithmetic with directed rounding for certified float evaluation.
+
+Float evaluation of `archimedes` can return a result of the wrong sign when a triangle is close
+to degenerate. An `Interval` carries a lower and an upper float bound that are guaranteed to
+enclose the exact real result. Python floats always round to nearest, so directed rounding is
+emulated: the rounding error of every sum and product is recovered exactly with the
+error-free transformations TwoSum and TwoProduct (Dekker's splitting), and a bound is moved
+one ulp outwards only when the rounded result is on the wrong side. Operations on exactly
+representable results, e.g. on integer-valued floats, therefore stay exact.
+
+The batch functions keep the bounds in two `array("d")` columns, and `archimedes_sign_batch`
+escalates only the elements whose enclosure contains zero to exact `Fraction` arithmetic.
+"""
+
+import math
+import struct
+import sys
+from array import array
+from fractions import Fraction
+from typing import Iterable, List, Optional, Sequence, Tuple, Union
+
+Number = Union[int, float, Fraction]
+
+_INF = float("inf")
+_SPLITTER = 134217729.0  # 2^27 + 1
+_SPLIT_MAX = 2.0**995  # beyond this Dekker's splitting may overflow
+_PRODUCT_MIN = 2.0**-969  # below this the product error may be subnormal
+
+if hasattr(math, "nextafter"):
+
+    def _next_up(x: float) -> float:
+        return math.nextafter(x, _INF)
+
+    def _next_down(x: float) -> float:
+        return math.nextafter(x, -_INF)
+
+else:  # pragma: no cover (Python 3.8)
+
+    def _next_up(x: float) -> float:
+        if x != x or x == _INF:
+            return x
+        if x == 0.0:
+            return 5e-324
+        (bits,) = struct.unpack("<q", struct.pack("<d", x))
+        bits += 1 if x > 0.0 else -1
+        return struct.unpack("<d", struct.pack("<q", bits))[0]
+
+    def _next_down(x: float) -> float:
+        return -_next_up(-x)
+
+
+def _sum_error(a: float, b: float, s: float) -> float:
+    """TwoSum: the exact error `a + b - s` of the rounded sum `s`"""
+    bv = s - a
+    av = s - bv
+    return (a - av) + (b - bv)
+
+
+def _split(a: float) -> Tuple[float, float]:
+    c = _SPLITTER * a
+    hi = c - (c - a)
+    return hi, a - hi
+
+
+def _product_error(a: float, b: float, p: float) -> Optional[float]:
+    """TwoProduct: the exact error `a * b - p`, or `None` if it cannot be computed exactly"""
+    if not (abs(a) < _SPLIT_MAX and abs(b) < _SPLIT_MAX and math.isfinite(p)):
+        return None
+    if abs(p) < _PRODUCT_MIN:
+        # a product of nonzero factors may have underflowed, even to zero
+        return 0.0 if a == 0.0 or b == 0.0 else None
+    a_hi, a_lo = _split(a)
+    b_hi, b_lo = _split(b)
+    return ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo
+
+
+def _add_down(a: float, b: float) -> float:
+    s = a + b
+    if math.isfinite(s):
+        return s if _sum_error(a, b, s) >= 0.0 else _next_down(s)
+    if s == _INF and math.isfinite(a) and math.isfinite(b):
+        return sys.float_info.max  # overflow of a finite sum
+    return s if s == s else -_INF
+
+
+def _add_up(a: float, b: float) -> float:
+    s = a + b
+    if math.isfinite(s):
+        return s if _sum_error(a, b, s) <= 0.0 else _next_up(s)
+    if s == -_INF and math.isfinite(a) and math.isfinite(b):
+        return -sys.float_info.max
+    return s if s == s else _INF
+
+
+def _mul_down(a: float, b: float) -> float:
+    p = a * b
+    e = _product_error(a, b, p)
+    if e is None:  # overflow, underflow or non-finite operands: widen unconditionally
+        if p != p:
+            return -_INF
+        return p if p == -_INF else _next_down(p)
+    return p if e >= 0.0 else _next_down(p)
+
+
+def _mul_up(a: float, b: float) -> float:
+    p = a * b
+    e = _product_error(a, b, p)
+    if e is None:
+        if p != p:
+            return _INF
+        return p if p == _INF else _next_up(p)
+    return p if e <= 0.0 else _next_up(p)
+
+
+class Interval:
+    """
+    A closed interval `[lo, hi]` of reals with float bounds.
+
+    Example:
+        >>> x = Interval.from_value(Fraction(1, 3))
+        >>> x.lo < Fraction(1, 3) < x.hi
+        True
+        >>> Interval(2.0) * Interval(4.0) - 1
+        Interval(7.0, 7.0)
+    """
+
+    __slots__ = ("lo", "hi")
+
+    def __init__(self, lo: float, hi: Optional[float] = None) -> None:
+        """
+        :param lo: The lower bound
+        :type lo: float
+        :param hi: The upper bound, by default equal to `lo`
+        :type hi: Optional[float]
+        """
+        self.lo = float(lo)
+        self.hi = self.lo if hi is None else float(hi)
+        if not self.lo <= self.hi:
+            raise ValueError(f"invalid interval [{lo}, {hi}]")
+
+    @classmethod
+    def from_value(cls, value: Number) -> "Interval":
+        """The tightest interval enclosing an exact `int`, `Fraction` or `float` value"""
+        if isinstance(value, Interval):
+            return value
+        if isinstance(value, float):
+            return cls(value)
+        try:
+            nearest = float(value)
+        except OverflowError:
+            big = sys.float_info.max
+            return cls(big, _INF) if value > 0 else cls(-_INF, -big)
+        exact = Fraction(nearest)
+        if exact == value:
+            return cls(nearest)
+        if exact < value:
+            return cls(nearest, _next_up(nearest))
+        return cls(_next_down(nearest), nearest)
+
+    def __repr__(self) -> str:
+        return f"Interval({self.lo!r}, {self.hi!r})"
+
+    def __eq__(self, other) -> bool:
+        if not isinstance(other, Interval):
+            return NotImplemented
+        return self.lo == other.lo and self.hi == other.hi
+
+    def __hash__(self) -> int:
+        return hash((self.lo, self.hi))
+
+    def __contains__(self, value: Number) -> bool:
+        return self.lo <= value <= self.hi
+
+    @property
+    def width(self) -> float:
+        return _add_up(self.hi, -self.lo)
+
+    def sign(self) -> Optional[int]:
+        """The sign of every point of the interval, or `None` if it is not determined"""
+        if self.lo > 0.0:
+            return 1
+        if self.hi < 0.0:
+            return -1
+        if self.lo == self.hi == 0.0:
+            return 0
+        return None
+
+    def __add__(self, other):
+        try:
+            other = Interval.from_value(other)
+        except TypeError:
+            return NotImplemented
+        return Interval(_add_down(self.lo, other.lo), _add_up(self.hi, other.hi))
+
+    __radd__ = __add__
+
+    def __neg__(self) -> "Interval":
+        return Interval(-self.hi, -self.lo)
+
+    def __sub__(self, other):
+        try:
+            other = Interval.from_value(other)
+        except TypeError:
+            return NotImplemented
+        return Interval(_add_down(self.lo, -other.hi), _add_up(self.hi, -other.lo))
+
+    def __rsub__(self, other):
+        return -self + other
+
+    def __mul__(self, other):
+        if other is self:
+            return self.square()
+        try:
+            other = Interval.from_value(other)
+        except TypeError:
+            return NotImplemented
+        a, b, c, d = self.lo, self.hi, other.lo, other.hi
+        return Interval(
+            min(_mul_down(a, c), _mul_down(a, d), _mul_down(b, c), _mul_down(b, d)),
+            max(_mul_up(a, c), _mul_up(a, d), _mul_up(b, c), _mul_up(b, d)),
+        )
+
+    __rmul__ = __mul__
+
+    def square(self) -> "Interval":
+        """The square, which unlike `x * y` knows both factors are the same variable"""
+        lo, hi = self.lo, self.hi
+        if lo >= 0.0:
+            return Interval(_mul_down(lo, lo), _mul_up(hi, hi))
+        if hi <= 0.0:
+            return Interval(_mul_down(hi, hi), _mul_up(lo, lo))
+        return Interval(0.0, max(_mul_up(lo, lo), _mul_up(hi, hi)))
+
+
+# ---- batch evaluation over float64 columns ----
+
+
+def archimedes_interval_batch(
+    q_1s: Iterable[float], q_2s: Iterable[float], q_3s: Iterable[float]
+) -> Tuple[array, array]:
+    """
+    The function `archimedes_interval_batch` encloses `archimedes` for columns of float
+    quadrances, each taken as an exact value.
+
+    :param q_1s: The first quadrances
+    :type q_1s: Iterable[float]
+    :param q_2s: The second quadrances
+    :type q_2s: Iterable[float]
+    :param q_3s: The third quadrances
+    :type q_3s: Iterable[float]
+    :return: the lower and upper bounds as two `array("d")`
+
+    Example:
+        >>> lo, hi = archimedes_interval_batch([2.0, 0.1], [4.0, 0.2], [6.0, 0.3])
+        >>> list(lo), list(hi)
+        ([32.0, 0.07999999999999999], [32.0, 0.08000000000000002])
+    """
+    los, his = array("d"), array("d")
+    for q_1, q_2, q_3 in zip(q_1s, q_2s, q_3s):
+        # temp = q_1 + q_2 - q_3
+        s_lo, s_hi = _add_down(q_1, q_2), _add_up(q_1, q_2)
+        t_lo, t_hi = _add_down(s_lo, -q_3), _add_up(s_hi, -q_3)
+        p_lo = _mul_down(4.0, _mul_down(q_1, q_2))
+        p_hi = _mul_up(4.0, _mul_up(q_1, q_2))
+        if t_lo >= 0.0:
+            sq_lo, sq_hi = _mul_down(t_lo, t_lo), _mul_up(t_hi, t_hi)
+        elif t_hi <= 0.0:
+            sq_lo, sq_hi = _mul_down(t_hi, t_hi), _mul_up(t_lo, t_lo)
+        else:
+            sq_lo, sq_hi = 0.0, max(_mul_up(t_lo, t_lo), _mul_up(t_hi, t_hi))
+        los.append(_add_down(p_lo, -sq_hi))
+        his.append(_add_up(p_hi, -sq_lo))
+    return los, his
+
+
+def archimedes_sign_batch(
+    q_1s: Sequence[Number], q_2s: Sequence[Number], q_3s: Sequence[Number]
+) -> List[int]:
+    """
+    The function `archimedes_sign_batch` computes the exact signs of `archimedes` for columns
+    of quadrances: all elements are enclosed with float intervals first, and only those whose
+    enclosure contains zero are recomputed with exact `Fraction` arithmetic.
+
+    :param q_1s: The first quadrances (`float` values are taken as exact)
+    :type q_1s: Sequence[Number]
+    :param q_2s: The second quadrances
+    :type q_2s: Sequence[Number]
+    :param q_3s: The third quadrances
+    :type q_3s: Sequence[Number]
+    :return: the signs, in `(-1, 0, 1)`
+
+    Example:
+        >>> archimedes_sign_batch([2.0, 1.0], [4.0, 1.0], [6.0, 4.0])
+        [1, 0]
+    """
+    if all(type(q) is float for col in (q_1s, q_2s, q_3s) for q in col):
+        los, his = archimedes_interval_batch(q_1s, q_2s, q_3s)
+    else:
+        bounds = [
+            archimedes_interval(q_1, q_2, q_3)
+            for q_1, q_2, q_3 in zip(q_1s, q_2s, q_3s)
+        ]
+        los = array("d", (b.lo for b in bounds))
+        his = array("d", (b.hi for b in bounds))
+    signs = []
+    for i, (lo, hi) in enumerate(zip(los, his)):
+        if lo > 0.0:
+            signs.append(1)
+        elif hi < 0.0:
+            signs.append(-1)
+        else:
+            q_1, q_2, q_3 = Fraction(q_1s[i]), Fraction(q_2s[i]), Fraction(q_3s[i])
+            temp = q_1 + q_2 - q_3
+            value = 4 * q_1 * q_2 - temp * temp
+            signs.append((value > 0) - (value < 0))
+    return signs
+
+
+def archimedes_interval(q_1: Number, q_2: Number, q_3: Number) -> Interval:
+    """An enclosure of `archimedes` for exact `int`, `Fraction` or `float` quadrances"""
+    q_1, q_2, q_3 = (Interval.from_value(q) for q in (q_1, q_2, q_3))
+    temp = q_1 + q_2 - q_3
+    return 4 * q_1 * q_2 - temp.square()
@@ -0,0 +1,185 @@
+"""
+Inverse kinematics of planar serial chains in rational trigonometry.
+
+A two-link arm with link quadrances `q_1`, `q_2` based at the origin reaches a target of
+quadrance `q` exactly when the triangle with quadrances `(q_1, q_2, q)` exists, i.e. when
+`archimedes(q_1, q_2, q) >= 0`. The joint configuration then follows from the Cross law
+without any square root or inverse trigonometric function: every joint is described by a
+`Joint`, consisting of
+
+- the spread between the incoming and outgoing direction (the squared sine of the angle),
+- the dot product of the two (unnormalized) directions, whose sign is that of the cosine, and
+- the turn, the sign of their cross product (+1 counter-clockwise, -1 clockwise).
+
+Together these determine the joint angle uniquely, and all of them are rational for rational
+inputs. Integer inputs give `Fraction` spreads.
+"""
+
+from fractions import Fraction
+from typing import List, NamedTuple, Sequence, Tuple, Union
+
+from .trigonom import archimedes, archimedes_batch
+
+Number = Union[int, Fraction, float]
+Point = Tuple[Number, Number]
+
+
+class Joint(NamedTuple):
+    """A relative rotation given by its spread, the sign-carrying dot product and the turn"""
+
+    spread: Number
+    dot: Number
+    turn: int
+
+
+class TwoLinkSolution(NamedTuple):
+    """Inverse kinematics of a two-link arm
+
+    The absolute direction of link 1 is `base` followed by `shoulder`, and the direction of
+    link 2 is that followed by `elbow`.
+    """
+
+    reachable: bool
+    quadrea: Number  # archimedes(q_1, q_2, q), negative when unreachable
+    base: Joint  # from the x-axis to the ray towards the target
+    shoulder: Joint  # from the target ray to link 1
+    elbow: Joint  # from link 1 to link 2
+
+
+class ThreeLinkSolution(NamedTuple):
+    """Inverse kinematics of a two-link arm carrying a rigid tool link
+
+    `arm` positions the wrist (target minus tool vector); `tool` is the rotation from the ray
+    towards the wrist to the tool link.
+    """
+
+    arm: TwoLinkSolution
+    tool: Joint
+
+
+_NONE = Joint(0, 0, 0)
+
+
+def _div(num: Number, den: Number) -> Number:
+    """Exact division for integers, ordinary division otherwise (zero for a zero denominator)"""
+    if den == 0:
+        return num * 0
+    if type(num) is int and type(den) is int:
+        return Fraction(num, den)
+    return num / den
+
+
+def _sign(value: Number) -> int:
+    return (value > 0) - (value < 0)
+
+
+def _solve(q_1, q_2, x, y, q, quadrea, elbow_up: bool) -> TwoLinkSolution:
+    turn = 0 if quadrea <= 0 else 1 if elbow_up else -1
+    base = Joint(_div(y * y, q), x, _sign(y)) if q != 0 else _NONE
+    shoulder = Joint(_div(quadrea, 4 * q_1 * q), _div(q + q_1 - q_2, 2), turn)
+    elbow = Joint(_div(quadrea, 4 * q_1 * q_2), _div(q - q_1 - q_2, 2), -turn)
+    return TwoLinkSolution(quadrea >= 0, quadrea, base, shoulder, elbow)
+
+
+def solve_two_link(
+    q_1: Number, q_2: Number, target: Point, elbow_up: bool = True
+) -> TwoLinkSolution:
+    """
+    The function `solve_two_link` solves the inverse kinematics of a planar two-link arm
+    based at the origin.
+
+    :param q_1: The quadrance (squared length) of the first link, nonzero
+    :type q_1: Number
+    :param q_2: The quadrance of the second link, nonzero
+    :type q_2: Number
+    :param target: The target point of the end of the second link
+    :type target: Point
+    :param elbow_up: Choose the configuration with the elbow to the left of the target ray
+    :type elbow_up: bool
+    :return: the `TwoLinkSolution`. Spreads that are undefined (target at the origin) are
+        reported as zero; the joints of an unreachable target are meaningless.
+
+    Example:
+        >>> sol = solve_two_link(25, 25, (8, 0))
+        >>> sol.reachable, sol.quadrea
+        (True, 2304)
+        >>> sol.shoulder
+        Joint(spread=Fraction(9, 25), dot=Fraction(32, 1), turn=1)
+        >>> sol.elbow
+        Joint(spread=Fraction(576, 625), dot=Fraction(7, 1), turn=-1)
+    """
+    x, y = target
+    q = x * x + y * y
+    return _solve(q_1, q_2, x, y, q, archimedes(q_1, q_2, q), elbow_up)
+
+
+def solve_three_link(
+    q_1: Number, q_2: Number, tool: Point, target: Point, elbow_up: bool = True
+) -> ThreeLinkSolution:
+    """
+    The function `solve_three_link` solves a planar three-link arm whose last link has a
+    prescribed world-frame vector `tool`, i.e. a fixed end-effector orientation.
+
+    :param q_1: The quadrance of the first link
+    :type q_1: Number
+    :param q_2: The quadrance of the second link
+    :type q_2: Number
+    :param tool: The vector from the wrist to the end effector
+    :type tool: Point
+    :param target: The target point of the end effector
+    :type target: Point
+    :param elbow_up: Choose the configuration with the elbow to the left of the wrist ray
+    :type elbow_up: bool
+    :return: the `ThreeLinkSolution`
+    """
+    tx, ty = tool
+    wx, wy = target[0] - tx, target[1] - ty
+    arm = solve_two_link(q_1, q_2, (wx, wy), elbow_up)
+    dot = wx * tx + wy * ty
+    cross = wx * ty - wy * tx
+    spread = _div(cross * cross, (wx * wx + wy * wy) * (tx * tx + ty * ty))
+    return ThreeLinkSolution(arm, Joint(spread, dot, _sign(cross)))
+
+
+def reachable_batch(q_1: Number, q_2: Number, targets: Sequence[Point]) -> List[bool]:
+    """
+    The function `reachable_batch` tests many targets of one two-link arm for reachability.
+
+    :param q_1: The quadrance of the first link
+    :type q_1: Number
+    :param q_2: The quadrance of the second link
+    :type q_2: Number
+    :param targets: The target points
+    :type targets: Sequence[Point]
+    :return: for every target, whether `archimedes(q_1, q_2, q) >= 0`
+    """
+    n = len(targets)
+    qs = [x * x + y * y for x, y in targets]
+    return [a >= 0 for a in archimedes_batch([q_1] * n, [q_2] * n, qs)]
+
+
+def solve_two_link_batch(
+    q_1: Number, q_2: Number, targets: Sequence[Point], elbow_up: bool = True
+) -> List[TwoLinkSolution]:
+    """
+    The function `solve_two_link_batch` solves one two-link arm for many targets, e.g. all
+    targets of one control tick. The work per target is a fixed number of ring operations and
+    divisions, with no iteration or square root, so the latency is linear in the batch size.
+
+    :param q_1: The quadrance of the first link
+    :type q_1: Number
+    :param q_2: The quadrance of the second link
+    :type q_2: Number
+    :param targets: The target points
+    :type targets: Sequence[Point]
+    :param elbow_up: Choose the configuration with the elbow to the left of the target ray
+    :type elbow_up: bool
+    :return: the solutions, in the order of `targets`
+    """
+    n = len(targets)
+    qs = [x * x + y * y for x, y in targets]
+    quadreas = archimedes_batch([q_1] * n, [q_2] * n, qs)
+    return [
+        _solve(q_1, q_2, x, y, q, a, elbow_up)
+        for (x, y), q, a in zip(targets, qs, quadreas)
+    ]
@@ -0,0 +1,228 @@
+"""
+A lazily normalized rational number type.
+
+`fractions.Fraction` reduces every intermediate result by a gcd. In a formula such as
+`4 * q_1 * q_2 - temp * temp` only the final value needs to be in lowest terms, so
+`LazyFraction` keeps numerator and denominator unreduced through arithmetic and normalizes
+only when the canonical form is observed (`hash`, `numerator`, `denominator`, `repr`), or when
+the denominator grows past `LazyFraction.max_bits` bits. Comparisons are done by
+cross-multiplication and never need a reduction.
+
+`LazyFraction` mixes with `int` and `Fraction` (giving `LazyFraction`) and with `float`
+(giving `float`), and compares and hashes equal to the corresponding `Fraction`.
+"""
+
+from fractions import Fraction
+from math import gcd
+from typing import Tuple, Union
+
+Rational = Union[int, Fraction, "LazyFraction"]
+
+
+def _parts(value) -> Tuple[int, int]:
+    """Numerator and denominator of an exact operand, or raise `TypeError`"""
+    if isinstance(value, LazyFraction):
+        return value._num, value._den
+    if isinstance(value, int):
+        return value, 1
+    if isinstance(value, Fraction):
+        return value.numerator, value.denominator
+    raise TypeError
+
+
+class LazyFraction:
+    """
+    A rational number whose numerator and denominator are reduced on demand.
+
+    Example:
+        >>> q = LazyFraction(1, 2) + LazyFraction(1, 6)
+        >>> q
+        LazyFraction(2, 3)
+        >>> q == Fraction(2, 3), hash(q) == hash(Fraction(2, 3))
+        (True, True)
+    """
+
+    __slots__ = ("_num", "_den")
+
+    max_bits = 512  # reduce once the denominator has more bits than this
+
+    def __init__(self, numerator: Rational = 0, denominator: Rational = 1) -> None:
+        """
+        :param numerator: The numerator (`int`, `Fraction` or `LazyFraction`)
+        :type numerator: Rational
+        :param denominator: The denominator, nonzero
+        :type denominator: Rational
+        """
+        n_1, d_1 = _parts(numerator)
+        n_2, d_2 = _parts(denominator)
+        num, den = n_1 * d_2, d_1 * n_2
+        if den == 0:
+            raise ZeroDivisionError(f"LazyFraction({numerator}, 0)")
+        if den < 0:
+            num, den = -num, -den
+        self._num, self._den = num, den
+
+    @classmethod
+    def _make(cls, num: int, den: int) -> "LazyFraction":
+        """Construct from a positive denominator, reducing only past the size threshold"""
+        result = cls.__new__(cls)
+        if den.bit_length() > cls.max_bits:
+            g = gcd(num, den)
+            num, den = num // g, den // g
+        result._num, result._den = num, den
+        return result
+
+    def normalize(self) -> "LazyFraction":
+        """Reduce to lowest terms in place and return `self`"""
+        g = gcd(self._num, self._den)
+        if g != 1:
+            self._num //= g
+            self._den //= g
+        return self
+
+    @property
+    def numerator(self) -> int:
+        return self.normalize()._num
+
+    @property
+    def denominator(self) -> int:
+        return self.normalize()._den
+
+    def to_fraction(self) -> Fraction:
+        return Fraction(self._num, self._den)
+
+    def __repr__(self) -> str:
+        self.normalize()
+        return f"LazyFraction({self._num}, {self._den})"
+
+    def __str__(self) -> str:
+        return str(self.to_fraction())
+
+    def __hash__(self) -> int:
+        return hash(self.to_fraction())
+
+    def __float__(self) -> float:
+        return self._num / self._den
+
+    def __bool__(self) -> bool:
+        return self._num != 0
+
+    # ---- arithmetic ----
+
+    def __add__(self, other):
+        if isinstance(other, float):
+            return float(self) + other
+        try:
+            num, den = _parts(other)
+        except TypeError:
+            return NotImplemented
+        if den == self._den:
+            return LazyFraction._make(self._num + num, den)
+        return LazyFraction._make(self._num * den + num * self._den, self._den * den)
+
+    __radd__ = __add__
+
+    def __neg__(self) -> "LazyFraction":
+        return LazyFraction._make(-self._num, self._den)
+
+    def __pos__(self) -> "LazyFraction":
+        return self
+
+    def __abs__(self) -> "LazyFraction":
+        return LazyFraction._make(abs(self._num), self._den)
+
+    def __sub__(self, other):
+        if isinstance(other, float):
+            return float(self) - other
+        try:
+            num, den = _parts(other)
+        except TypeError:
+            return NotImplemented
+        if den == self._den:
+            return LazyFraction._make(self._num - num, den)
+        return LazyFraction._make(self._num * den - num * self._den, self._den * den)
+
+    def __rsub__(self, other):
+        return -self + other
+
+    def __mul__(self, other):
+        if isinstance(other, float):
+            return float(self) * other
+        try:
+            num, den = _parts(other)
+        except TypeError:
+            return NotImplemented
+        return LazyFraction._make(self._num * num, self._den * den)
+
+    __rmul__ = __mul__
+
+    def __truediv__(self, other):
+        if isinstance(other, float):
+            return float(self) / other
+        try:
+            num, den = _parts(other)
+        except TypeError:
+            return NotImplemented
+        if num == 0:
+            raise ZeroDivisionError("division by zero")
+        if num < 0:
+            num, den = -num, -den
+        return LazyFraction._make(self._num * den, self._den * num)
+
+    def __rtruediv__(self, other):
+        if isinstance(other, float):
+            return other / float(self)
+        try:
+            num, den = _parts(other)
+        except TypeError:
+            return NotImplemented
+        return LazyFraction(num, den) / self
+
+    def __pow__(self, exponent: int) -> "LazyFraction":
+        if not isinstance(exponent, int):
+            return NotImplemented
+        if exponent < 0:
+            return 1 / self ** (-exponent)
+        return LazyFraction._make(self._num**exponent, self._den**exponent)
+
+    # ---- comparisons, by cross-multiplication ----
+
+    def _cmp(self, other) -> int:
+        if isinstance(other, float):
+            if other != other:
+                raise TypeError("unordered")
+            value = self.to_fraction()
+            return (value > other) - (value < other)
+        num, den = _parts(other)
+        diff = self._num * den - num * self._den
+        return (diff > 0) - (diff < 0)
+
+    def __eq__(self, other) -> bool:
+        try:
+            return self._cmp(other) == 0
+        except TypeError:
+            return NotImplemented
+
+    def __lt__(self, other) -> bool:
+        try:
+            return self._cmp(other) < 0
+        except TypeError:
+            return NotImplemented
+
+    def __le__(self, other) -> bool:
+        try:
+            return self._cmp(other) <= 0
+        except TypeError:
+            return NotImplemented
+
+    def __gt__(self, other) -> bool:
+        try:
+            return self._cmp(other) > 0
+        except TypeError:
+            return NotImplemented
+
+    def __ge__(self, other) -> bool:
+        try:
+            return self._cmp(other) >= 0
+        except TypeError:
+            return NotImplemented
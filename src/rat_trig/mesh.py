@@ -0,0 +1,354 @@
+"""
+Streaming quadrea statistics for triangle meshes.
+
+Faces are read from Wavefront OBJ, PLY (ASCII and binary) and STL (ASCII and binary) files one
+chunk at a time. For every triangle the three quadrances and the quadrea given by `archimedes`
+are computed chunk-wise; a triangle is degenerate exactly when its quadrea is zero.
+
+Binary PLY and binary STL files are memory-mapped and decoded with `struct.iter_unpack`, the
+text formats are read line by line. Memory use is therefore independent of the number of
+faces; only the vertex table of indexed formats (OBJ, PLY) is kept, since faces may refer to
+any earlier vertex.
+"""
+
+import mmap
+import struct
+from dataclasses import dataclass, field
+from fractions import Fraction
+from itertools import islice
+from pathlib import Path
+from typing import Dict, Iterator, List, Optional, Sequence, Tuple, Union
+
+from .trigonom import archimedes_batch
+
+Vertex = Tuple[float, float, float]
+# (part name, face index, first vertex, second vertex, third vertex)
+Triangle = Tuple[str, int, Vertex, Vertex, Vertex]
+PathLike = Union[str, Path]
+
+_PLY_TYPES = {
+    "char": "b",
+    "int8": "b",
+    "uchar": "B",
+    "uint8": "B",
+    "short": "h",
+    "int16": "h",
+    "ushort": "H",
+    "uint16": "H",
+    "int": "i",
+    "int32": "i",
+    "uint": "I",
+    "uint32": "I",
+    "float": "f",
+    "float32": "f",
+    "double": "d",
+    "float64": "d",
+}
+
+
+@dataclass
+class MeshStats:
+    """Aggregate statistics of a mesh scan"""
+
+    faces: int = 0
+    degenerate_count: int = 0
+    # indices of the first `max_reported` degenerate faces
+    degenerate: List[int] = field(default_factory=list)
+    total_quadrea: Dict[str, Union[float, Fraction]] = field(default_factory=dict)
+    min_quadrea: Optional[Union[float, Fraction]] = None
+    max_quadrea: Optional[Union[float, Fraction]] = None
+
+
+# ---- readers ----
+
+
+def _fan(part: str, index: int, verts: Sequence[Vertex]) -> Iterator[Triangle]:
+    """Triangulate a convex polygon as a fan; all triangles keep the source face index"""
+    for k in range(1, len(verts) - 1):
+        yield (part, index, verts[0], verts[k], verts[k + 1])
+
+
+def _read_obj(path: PathLike) -> Iterator[Triangle]:
+    vertices: List[Vertex] = []
+    part = ""
+    index = 0
+    with open(path, "r") as fin:
+        for line in fin:
+            tokens = line.split()
+            if not tokens:
+                continue
+            tag = tokens[0]
+            if tag == "v":
+                vertices.append((float(tokens[1]), float(tokens[2]), float(tokens[3])))
+            elif tag == "f":
+                refs = [int(t.split("/", 1)[0]) for t in tokens[1:]]
+                n = len(vertices)
+                verts = [vertices[r - 1 if r > 0 else n + r] for r in refs]
+                yield from _fan(part, index, verts)
+                index += 1
+            elif tag in ("o", "g"):
+                part = " ".join(tokens[1:])
+
+
+def _ply_header(fin) -> Tuple[str, list]:
+    """Parse a PLY header into its format and a list of `(element, count, properties)`"""
+    if fin.readline().strip() != b"ply":
+        raise ValueError("not a PLY file")
+    fmt = ""
+    elements: list = []
+    while True:
+        line = fin.readline()
+        if not line:
+            raise ValueError("unterminated PLY header")
+        tokens = line.decode("ascii").split()
+        if not tokens or tokens[0] in ("comment", "obj_info"):
+            continue
+        if tokens[0] == "end_header":
+            return fmt, elements
+        if tokens[0] == "format":
+            fmt = tokens[1]
+        elif tokens[0] == "element":
+            elements.append((tokens[1], int(tokens[2]), []))
+        elif tokens[0] == "property":
+            if tokens[1] == "list":
+                prop = (tokens[4], _PLY_TYPES[tokens[2]], _PLY_TYPES[tokens[3]])
+            else:
+                prop = (tokens[2], _PLY_TYPES[tokens[1]], "")
+            elements[-1][2].append(prop)
+
+
+def _read_ply(path: PathLike) -> Iterator[Triangle]:
+    with open(path, "rb") as fin:
+        fmt, elements = _ply_header(fin)
+        offset = fin.tell()
+        if fmt == "ascii":
+            yield from _read_ply_ascii(fin, elements)
+            return
+        if fmt not in ("binary_little_endian", "binary_big_endian"):
+            raise ValueError(f"unsupported PLY format {fmt!r}")
+        endian = "<" if fmt == "binary_little_endian" else ">"
+        with mmap.mmap(fin.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            view = memoryview(mm)
+            try:
+                yield from _read_ply_binary(view, offset, endian, elements)
+            finally:
+                view.release()
+
+
+def _read_ply_ascii(fin, elements: list) -> Iterator[Triangle]:
+    vertices: List[Vertex] = []
+    for name, count, props in elements:
+        names = [p[0] for p in props]
+        for index in range(count):
+            tokens = fin.readline().split()
+            if name == "vertex":
+                row = dict(zip(names, tokens))
+                vertices.append((float(row["x"]), float(row["y"]), float(row["z"])))
+            elif name == "face":
+                # walk the row; every list property is prefixed by its length
+                pos = 0
+                for prop_name, kind, item in props:
+                    if item:
+                        n = int(tokens[pos])
+                        if prop_name in ("vertex_indices", "vertex_index"):
+                            refs = tokens[pos + 1 : pos + 1 + n]
+                            verts = [vertices[int(r)] for r in refs]
+                            yield from _fan("", index, verts)
+                        pos += 1 + n
+                    else:
+                        pos += 1
+
+
+def _read_ply_binary(
+    view: memoryview, offset: int, endian: str, elements: list
+) -> Iterator[Triangle]:
+    vertices: List[Vertex] = []
+    for name, count, props in elements:
+        if all(not item for _, _, item in props):
+            # fixed-size rows: decode the whole block without copying it
+            layout = struct.Struct(endian + "".join(kind for _, kind, _ in props))
+            end = offset + count * layout.size
+            if name == "vertex":
+                names = [p[0] for p in props]
+                ix, iy, iz = names.index("x"), names.index("y"), names.index("z")
+                vertices = [
+                    (row[ix], row[iy], row[iz])
+                    for row in layout.iter_unpack(view[offset:end])
+                ]
+            offset = end
+            continue
+        for index in range(count):
+            for prop_name, kind, item in props:
+                if not item:
+                    offset += struct.calcsize(kind)
+                    continue
+                (n,) = struct.unpack_from(endian + kind, view, offset)
+                offset += struct.calcsize(kind)
+                refs = struct.unpack_from(f"{endian}{n}{item}", view, offset)
+                offset += n * struct.calcsize(item)
+                if name == "face" and prop_name in ("vertex_indices", "vertex_index"):
+                    yield from _fan("", index, [vertices[r] for r in refs])
+
+
+def _read_stl(path: PathLike) -> Iterator[Triangle]:
+    size = Path(path).stat().st_size
+    with open(path, "rb") as fin:
+        head = fin.read(84)
+        binary = len(head) == 84 and size == 84 + 50 * struct.unpack("<I", head[80:])[0]
+        if not binary:
+            fin.seek(0)
+            yield from _read_stl_ascii(fin)
+            return
+        if size == 84:
+            return
+        with mmap.mmap(fin.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            view = memoryview(mm)
+            try:
+                for index, r in enumerate(struct.iter_unpack("<12fH", view[84:])):
+                    yield ("", index, r[3:6], r[6:9], r[9:12])
+            finally:
+                view.release()
+
+
+def _read_stl_ascii(fin) -> Iterator[Triangle]:
+    part = ""
+    index = 0
+    verts: List[Vertex] = []
+    for line in fin:
+        tokens = line.split()
+        if not tokens:
+            continue
+        tag = tokens[0]
+        if tag == b"vertex":
+            verts.append((float(tokens[1]), float(tokens[2]), float(tokens[3])))
+        elif tag == b"endfacet":
+            yield from _fan(part, index, verts)
+            index += 1
+            verts = []
+        elif tag == b"solid":
+            part = b" ".join(tokens[1:]).decode()
+
+
+_READERS = {".obj": _read_obj, ".ply": _read_ply, ".stl": _read_stl}
+
+
+def read_triangles(path: PathLike) -> Iterator[Triangle]:
+    """
+    The function `read_triangles` streams the triangles of a mesh file. Polygonal faces are
+    triangulated as fans and every triangle carries the index of its source face.
+
+    :param path: The mesh file; the format is chosen by the `.obj`, `.ply` or `.stl` suffix
+    :type path: PathLike
+    :return: an iterator of `(part, face_index, v_1, v_2, v_3)` tuples. The part is the OBJ
+        object/group name or the ASCII STL solid name, and the empty string otherwise.
+    """
+    suffix = Path(path).suffix.lower()
+    if suffix not in _READERS:
+        raise ValueError(f"unsupported mesh format {suffix!r}")
+    return _READERS[suffix](path)
+
+
+# ---- quadrea ----
+
+
+def quadrea_chunk(
+    triangles: Sequence[Triangle], exact: bool = False
+) -> List[Union[float, Fraction]]:
+    """
+    The function `quadrea_chunk` computes the quadreas of a chunk of triangles, column by column.
+
+    :param triangles: The triangles as produced by `read_triangles`
+    :type triangles: Sequence[Triangle]
+    :param exact: If true, the (binary floating-point) coordinates are converted exactly to
+        `Fraction` first, so that zero quadrea means exactly collinear vertices
+    :type exact: bool
+    :return: the list of quadreas
+    """
+    if exact:
+        triangles = [
+            (p, i, *(tuple(map(Fraction, v)) for v in vs)) for p, i, *vs in triangles
+        ]
+    q_1s = [_quadrance3(b, c) for _, _, _, b, c in triangles]
+    q_2s = [_quadrance3(a, c) for _, _, a, _, c in triangles]
+    q_3s = [_quadrance3(a, b) for _, _, a, b, _ in triangles]
+    return archimedes_batch(q_1s, q_2s, q_3s)
+
+
+def _quadrance3(p, q):
+    dx, dy, dz = p[0] - q[0], p[1] - q[1], p[2] - q[2]
+    return dx * dx + dy * dy + dz * dz
+
+
+def _chunks(path: PathLike, chunk_size: int) -> Iterator[List[Triangle]]:
+    triangles = read_triangles(path)
+    while True:
+        chunk = list(islice(triangles, chunk_size))
+        if not chunk:
+            return
+        yield chunk
+
+
+def iter_degenerate(
+    path: PathLike, chunk_size: int = 65536, exact: bool = False
+) -> Iterator[int]:
+    """
+    The function `iter_degenerate` streams the indices of the faces with zero quadrea.
+
+    :param path: The mesh file
+    :type path: PathLike
+    :param chunk_size: The number of triangles processed per chunk
+    :type chunk_size: int
+    :param exact: Compute the quadreas exactly, see `quadrea_chunk`
+    :type exact: bool
+    :return: an iterator of face indices, in file order and without repetitions
+    """
+    last = -1
+    for chunk in _chunks(path, chunk_size):
+        for tri, quadrea in zip(chunk, quadrea_chunk(chunk, exact)):
+            if quadrea == 0 and tri[1] != last:
+                last = tri[1]
+                yield last
+
+
+def scan_mesh(
+    path: PathLike,
+    chunk_size: int = 65536,
+    exact: bool = False,
+    max_reported: Optional[int] = 1000,
+) -> MeshStats:
+    """
+    The function `scan_mesh` computes the quadrea statistics of a mesh file in one streaming
+    pass.
+
+    :param path: The mesh file
+    :type path: PathLike
+    :param chunk_size: The number of triangles processed per chunk
+    :type chunk_size: int
+    :param exact: Compute the quadreas exactly, see `quadrea_chunk`
+    :type exact: bool
+    :param max_reported: The maximum number of degenerate face indices kept in the result
+        (`None` for all); the total is always counted
+    :type max_reported: Optional[int]
+    :return: the `MeshStats` of the mesh. A polygonal face counts once, and is degenerate if
+        any triangle of its fan is.
+    """
+    stats = MeshStats()
+    last_face = last_degenerate = -1
+    for chunk in _chunks(path, chunk_size):
+        quadreas = quadrea_chunk(chunk, exact)
+        for (part, index, *_), quadrea in zip(chunk, quadreas):
+            if index != last_face:
+                stats.faces += 1
+                last_face = index
+            stats.total_quadrea[part] = stats.total_quadrea.get(part, 0) + quadrea
+            if quadrea == 0 and index != last_degenerate:
+                last_degenerate = index
+                stats.degenerate_count += 1
+                if max_reported is None or len(stats.degenerate) < max_reported:
+                    stats.degenerate.append(index)
+        low, high = min(quadreas), max(quadreas)
+        if stats.min_quadrea is None or low < stats.min_quadrea:
+            stats.min_quadrea = low
+        if stats.max_quadrea is None or high > stats.max_quadrea:
+            stats.max_quadrea = high
+    return stats
@@ -0,0 +1,400 @@
+"""
+A fast parser for rational literals in delimited text.
+
+Fields may be integers (`-123`), fractions (`-123/456`) or decimals with an optional
+exponent (`1.25`, `-.5`, `3e-2`). `parse_rational` turns any of them into an exact
+numerator and positive denominator. `fractions.Fraction` runs a regular expression for each
+value; this module parses a whole column at once instead. It first tries `map(int, ...)`,
+which runs in C and covers the common all-integer column. Only the columns that contain
+other notations are parsed field by field.
+
+`iter_chunks` splits lines into chunks of columns of the requested numeric type. A malformed
+record raises `ParseError`, which carries the line number and the field number.
+
+Numerator and denominator columns are returned as `array("q")` when every value fits in
+int64, and as lists of Python integers otherwise.
+
+With `native=True`, `iter_chunks` first hands each chunk to a C tokenizer, which is built
+with the system C compiler like the kernels of `rat_trig.codegen` and cached the same way.
+It reads the joined lines in one pass and writes int64 numerators and denominators straight
+into `array("q")` buffers, without creating a Python string per field. It handles integers
+and `p/q` fractions that fit in int64. A chunk with any other field, and every chunk when no C
+compiler is available, is parsed by the Python code above, which also reports the errors.
+
+`experiments/bench_parse.py` measures both tokenizers against `Fraction(str)`.
+"""
+
+import ctypes
+import functools
+import operator
+from array import array
+from itertools import islice, repeat
+from pathlib import Path
+from typing import Iterable, Iterator, List, Optional, Sequence, Tuple, Union
+
+from .batch_gcd import _coprime, to_fractions
+from .codegen import _cache_dir, build_shared_object
+
+IntColumn = Union[array, List[int]]
+
+KINDS = ("int", "fraction", "float")
+MAX_EXPONENT = 10000
+
+
+class ParseError(ValueError):
+    """A malformed record, with its 1-based line and field numbers when known"""
+
+    def __init__(
+        self, message: str, line: Optional[int] = None, field: Optional[int] = None
+    ) -> None:
+        self.reason = message
+        self.line = line
+        self.field = field
+        where = []
+        if line is not None:
+            where.append(f"line {line}")
+        if field is not None:
+            where.append(f"field {field}")
+        super().__init__(f"{', '.join(where)}: {message}" if where else message)
+
+    def __reduce__(self):
+        return ParseError, (self.reason, self.line, self.field)
+
+
+class _BadField(ValueError):
+    def __init__(self, index: int, message: str) -> None:
+        super().__init__(message)
+        self.index = index
+
+
+# the characters of rational literals; `int` and `float` also accept other Unicode digits,
+# underscores between digits, and `inf` and `nan`
+_LITERAL_CHARS = str.maketrans("", "", "0123456789+-./eE \t\n\r\f\v")
+
+
+def _digits(text: str) -> bool:
+    return not text or (text.isascii() and text.isdigit())
+
+
+def _plain(fields: Sequence[str]) -> bool:
+    """Whether the fields use only the characters of rational literals"""
+    return not "".join(fields).translate(_LITERAL_CHARS)
+
+
+def parse_rational(token: str) -> Tuple[int, int]:
+    """
+    The function `parse_rational` parses one rational literal exactly.
+
+    :param token: An integer, `p/q` fraction or decimal literal, optionally surrounded by
+        whitespace
+    :type token: str
+    :raises ValueError: if the literal is malformed or has a zero denominator
+    :return: the numerator and the positive denominator, not necessarily reduced
+
+    Example:
+        >>> parse_rational("-123/456"), parse_rational("1.25"), parse_rational("-.5e-1")
+        ((-123, 456), (125, 100), (-5, 100))
+    """
+    text = token.strip()
+    if not _plain((text,)):
+        raise ValueError(f"invalid rational literal {token!r}")
+    num_text, slash, den_text = text.partition("/")
+    if slash:
+        num, den = int(num_text), int(den_text)
+    else:
+        mantissa, e, exp_text = text.replace("E", "e").partition("e")
+        exp = int(exp_text) if e else 0
+        if abs(exp) > MAX_EXPONENT:
+            raise ValueError(f"exponent out of range in {token!r}")
+        whole, _, frac = mantissa.partition(".")
+        sign = whole[:1] if whole[:1] in ("+", "-") else ""
+        whole = whole[len(sign) :]
+        if not (whole or frac) or not _digits(whole) or not _digits(frac):
+            raise ValueError(f"invalid rational literal {token!r}")
+        num = int(sign + whole + frac)
+        den = 10 ** len(frac)
+        if exp >= 0:
+            num *= 10**exp
+        else:
+            den *= 10**-exp
+    if den == 0:
+        raise ValueError(f"zero denominator in {token!r}")
+    if den < 0:
+        num, den = -num, -den
+    return num, den
+
+
+def _int_column(values: List[int]) -> IntColumn:
+    try:
+        return array("q", values)
+    except OverflowError:
+        return values
+
+
+def parse_column(fields: Sequence[str]) -> Tuple[IntColumn, Optional[IntColumn]]:
+    """
+    The function `parse_column` parses a column of rational literals.
+
+    :param fields: The literals
+    :type fields: Sequence[str]
+    :raises ValueError: if a literal is malformed; its position is the `index` attribute
+    :return: the numerators and denominators; the denominators are `None` if every
+        literal is an integer
+
+    Example:
+        >>> parse_column(["1", "-2"])
+        (array('q', [1, -2]), None)
+        >>> parse_column(["1/3", "0.5"])
+        (array('q', [1, 5]), array('q', [3, 10]))
+    """
+    # `int` accepts more than `parse_rational`, so the fast paths need plain characters
+    if _plain(fields):
+        try:
+            return _int_column(list(map(int, fields))), None
+        except ValueError:
+            pass
+        try:  # a column of p/q fractions
+            num_texts, _, den_texts = zip(*map(str.partition, fields, repeat("/")))
+            nums, dens = list(map(int, num_texts)), list(map(int, den_texts))
+        except ValueError:
+            pass
+        else:
+            if min(dens) > 0:
+                return _int_column(nums), _int_column(dens)
+    nums, dens = [], []
+    for index, field in enumerate(fields):
+        try:
+            num, den = parse_rational(field)
+        except ValueError as err:
+            raise _BadField(index, str(err)) from None
+        nums.append(num)
+        dens.append(den)
+    return _int_column(nums), _int_column(dens)
+
+
+def to_numbers(
+    nums: IntColumn, dens: Optional[IntColumn], kind: str = "fraction"
+) -> Sequence:
+    """
+    The function `to_numbers` converts parsed numerators and denominators to one numeric type.
+
+    :param nums: The numerators
+    :param dens: The denominators, `None` for integers
+    :param kind: `"int"`, `"fraction"` or `"float"`
+    :type kind: str
+    :raises ValueError: for a non-integer value with `kind == "int"`; its position is the
+        `index` attribute
+    :return: the values
+    """
+    if kind == "int":
+        if dens is None:
+            return nums
+        for index, (num, den) in enumerate(zip(nums, dens)):
+            if num % den:
+                raise _BadField(index, f"{num}/{den} is not an integer")
+        return list(map(operator.floordiv, nums, dens))
+    if kind == "float":
+        try:
+            if dens is None:
+                return list(map(float, nums))
+            return list(map(operator.truediv, nums, dens))
+        except OverflowError:
+            pass
+        for index, num in enumerate(nums):
+            try:
+                num / (1 if dens is None else dens[index])
+            except OverflowError:
+                raise _BadField(index, "value out of range for float") from None
+    if kind == "fraction":
+        if dens is None:
+            return list(map(_coprime, nums, repeat(1)))
+        return to_fractions(nums, dens)
+    raise ValueError(f"unknown numeric type {kind!r}")
+
+
+def _parse_float_column(fields: Sequence[str]) -> Optional[List[float]]:
+    if not _plain(fields):
+        return None
+    try:
+        return list(map(float, fields))
+    except ValueError:
+        return None
+
+
+_TOKENIZER_C = r"""
+#include <stdint.h>
+
+/* one optionally signed decimal integer; NULL if it is empty or does not fit in int64 */
+static const char *parse_int(const char *p, const char *end, int64_t *out)
+{
+    int neg = 0;
+    int64_t value = 0;
+    const char *start;
+    if (p < end && (*p == '+' || *p == '-')) {
+        neg = *p == '-';
+        p++;
+    }
+    start = p;
+    /* accumulate negatively, so that INT64_MIN fits */
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (__builtin_mul_overflow(value, 10, &value)
+            || __builtin_sub_overflow(value, *p - '0', &value))
+            return 0;
+    }
+    if (p == start || (!neg && value == INT64_MIN))
+        return 0;
+    *out = neg ? value : -value;
+    return p;
+}
+
+/* Parse `nrows` lines of `ncols` fields into column-major numerator and denominator blocks,
+   and flag the columns with a `p/q` field. Returns -1 on success, and otherwise the index of
+   the first line it cannot parse. */
+int64_t rt_tokenize(const char *buf, int64_t len, char delim, int64_t ncols, int64_t nrows,
+                    int64_t *nums, int64_t *dens, int64_t *fractions)
+{
+    const char *p = buf, *end = buf + len;
+    for (int64_t row = 0; row < nrows; row++) {
+        for (int64_t k = 0; k < ncols; k++) {
+            int64_t num, den = 1;
+            if (!(p = parse_int(p, end, &num)))
+                return row;
+            if (p < end && *p == '/') {
+                if (!(p = parse_int(p + 1, end, &den)) || den <= 0)
+                    return row;
+                fractions[k] = 1;
+            }
+            nums[k * nrows + row] = num;
+            dens[k * nrows + row] = den;
+            if (k + 1 < ncols) {
+                if (p == end || *p != delim)
+                    return row;
+                p++;
+            }
+        }
+        if (row + 1 < nrows) {
+            if (p == end || *p != '\n')
+                return row;
+            p++;
+        }
+    }
+    return p == end ? -1 : nrows - 1;
+}
+"""
+
+
+@functools.lru_cache(maxsize=None)
+def _load_tokenizer(cache_dir: Path):
+    try:
+        path = build_shared_object(_TOKENIZER_C, cache_dir)
+        func = ctypes.CDLL(str(path)).rt_tokenize
+    except (RuntimeError, OSError):
+        return None
+    pointer = ctypes.POINTER(ctypes.c_int64)
+    func.argtypes = [ctypes.c_char_p, ctypes.c_int64, ctypes.c_char, ctypes.c_int64]
+    func.argtypes += [ctypes.c_int64] + [pointer] * 3
+    func.restype = ctypes.c_int64
+    return func
+
+
+def _address(buf: array):
+    return ctypes.cast(buf.buffer_info()[0], ctypes.POINTER(ctypes.c_int64))
+
+
+def _tokenize(
+    lines: Sequence[str], ncols: int, delimiter: str
+) -> Optional[List[Tuple[IntColumn, Optional[IntColumn]]]]:
+    """
+    The numerators and denominators of every column from the C tokenizer, or `None` if it is
+    not available or cannot parse the lines.
+    """
+    func = _load_tokenizer(_cache_dir())
+    if func is None or len(delimiter) != 1 or not ncols:
+        return None
+    try:
+        data = "\n".join(map(str.rstrip, lines, repeat("\r\n"))).encode("ascii")
+        sep = delimiter.encode("ascii")
+    except UnicodeEncodeError:
+        return None
+    nrows = len(lines)
+    nums, dens = (array("q", bytes(8 * nrows * ncols)) for _ in "nd")
+    fractions = array("q", bytes(8 * ncols))
+    args = (data, len(data), sep, ncols, nrows, *map(_address, (nums, dens, fractions)))
+    if func(*args) >= 0:
+        return None
+    blocks = range(0, nrows * ncols, nrows)
+    return [
+        (nums[i : i + nrows], dens[i : i + nrows] if frac else None)
+        for i, frac in zip(blocks, fractions)
+    ]
+
+
+def iter_chunks(
+    lines: Iterable[str],
+    ncols: int,
+    kind: str = "fraction",
+    delimiter: str = "",
+    chunk_size: int = 65536,
+    first_line: int = 1,
+    native: bool = False,
+) -> Iterator[List[Sequence]]:
+    """
+    The function `iter_chunks` parses delimited lines of rational literals into chunks of
+    columns, skipping blank lines and `#` comments.
+
+    :param lines: The input lines
+    :type lines: Iterable[str]
+    :param ncols: The number of fields per record
+    :type ncols: int
+    :param kind: The numeric type of the columns, `"int"`, `"fraction"` or `"float"`
+    :type kind: str
+    :param delimiter: The field separator; by default a tab if the first record contains one,
+        and a comma otherwise
+    :type delimiter: str
+    :param chunk_size: The maximum number of records per chunk
+    :type chunk_size: int
+    :param first_line: The line number of the first line
+    :type first_line: int
+    :param native: Try the C tokenizer first; it needs a C compiler on the first call
+    :type native: bool
+    :raises ParseError: for a malformed record
+    :return: for every chunk, one column of values per field
+
+    Example:
+        >>> list(iter_chunks(["# q_1,q_2", "1,1/2", "", "2,0.25"], 2))
+        [[[Fraction(1, 1), Fraction(2, 1)], [Fraction(1, 2), Fraction(1, 4)]]]
+    """
+    if kind not in KINDS:
+        raise ValueError(f"unknown numeric type {kind!r}")
+    numbered = enumerate(lines, first_line)
+    records = ((n, line) for n, line in numbered if line.strip() and line[0] != "#")
+    while True:
+        chunk = list(islice(records, chunk_size))
+        if not chunk:
+            return
+        if not delimiter:
+            delimiter = "\t" if "\t" in chunk[0][1] else ","
+        parsed = (
+            _tokenize([line for _, line in chunk], ncols, delimiter) if native else None
+        )
+        if parsed is None:
+            rows = [line.split(delimiter) for _, line in chunk]
+            for (lineno, _), row in zip(chunk, rows):
+                if len(row) != ncols:
+                    raise ParseError(f"expected {ncols} fields, got {len(row)}", lineno)
+        columns = []
+        for k in range(ncols if parsed is None else 0):
+            fields = [row[k] for row in rows]
+            values = _parse_float_column(fields) if kind == "float" else None
+            if values is None:
+                try:
+                    values = to_numbers(*parse_column(fields), kind)
+                except _BadField as err:
+                    raise ParseError(str(err), chunk[err.index][0], k + 1) from None
+            columns.append(values)
+        for k, (nums, dens) in enumerate(parsed or ()):
+            try:
+                columns.append(to_numbers(nums, dens, kind))
+            except _BadField as err:
+                raise ParseError(str(err), chunk[err.index][0], k + 1) from None
+        yield columns
@@ -0,0 +1,204 @@
+"""
+Points and lines as homogeneous integer triples.
+
+The point `[x : y : z]` is the affine point `(x / z, y / z)`, and the line `<a : b : c>` is
+`a x + b y + c = 0`. The line through two points and the point on two lines are both given by
+the cross product of the triples, so meets and joins only use integer ring operations. Triples
+are reduced by their content (gcd) only once an entry grows past `max_bits` bits, instead of
+at every construction step as with `Fraction` coordinates.
+
+Quadrances between homogeneous points are returned as integer numerators over a common
+denominator. Since `archimedes` is homogeneous of degree two, it can be applied to those
+numerators directly: the quadrea is `archimedes(n_1, n_2, n_3) / d^2`.
+"""
+
+from fractions import Fraction
+from math import gcd
+from typing import List, Optional, Sequence, Tuple, Union
+
+from .trigonom import archimedes, archimedes_batch
+
+Triple = Tuple[int, int, int]
+Number = Union[int, Fraction]
+
+REDUCE_BITS = 128
+
+
+def cross(u: Triple, v: Triple) -> Triple:
+    """The cross product of two triples"""
+    return (
+        u[1] * v[2] - u[2] * v[1],
+        u[2] * v[0] - u[0] * v[2],
+        u[0] * v[1] - u[1] * v[0],
+    )
+
+
+def normalize(v: Triple) -> Triple:
+    """
+    The function `normalize` divides a triple by its content and makes its last nonzero entry
+    positive, which gives a canonical representative.
+
+    Example:
+        >>> normalize((4, -6, -2))
+        (-2, 3, 1)
+    """
+    g = gcd(gcd(v[0], v[1]), v[2])
+    if g == 0:
+        return v
+    sign = v[2] or v[1] or v[0]
+    if sign < 0:
+        g = -g
+    return (v[0] // g, v[1] // g, v[2] // g)
+
+
+def reduce_content(v: Triple, max_bits: int = REDUCE_BITS) -> Triple:
+    """
+    The function `reduce_content` divides a triple by its content only if some entry has more
+    than `max_bits` bits; otherwise it is returned unchanged.
+    """
+    if max(abs(v[0]), abs(v[1]), abs(v[2])).bit_length() > max_bits:
+        g = gcd(gcd(v[0], v[1]), v[2])
+        if g > 1:
+            return (v[0] // g, v[1] // g, v[2] // g)
+    return v
+
+
+def point(x: Number, y: Number) -> Triple:
+    """
+    The function `point` converts an affine point with rational coordinates to a triple.
+
+    Example:
+        >>> point(Fraction(1, 2), Fraction(2, 3))
+        (3, 4, 6)
+    """
+    x, y = Fraction(x), Fraction(y)
+    return normalize(
+        (
+            x.numerator * y.denominator,
+            y.numerator * x.denominator,
+            x.denominator * y.denominator,
+        )
+    )
+
+
+def to_affine(p: Triple) -> Optional[Tuple[Fraction, Fraction]]:
+    """The affine coordinates of a point, or `None` for a point at infinity"""
+    if p[2] == 0:
+        return None
+    return Fraction(p[0], p[2]), Fraction(p[1], p[2])
+
+
+def join(p: Triple, q: Triple, max_bits: int = REDUCE_BITS) -> Triple:
+    """
+    The function `join` computes the line through two points.
+
+    :param p: The first point
+    :type p: Triple
+    :param q: The second point
+    :type q: Triple
+    :param max_bits: The entry size that triggers a content reduction of the result
+    :type max_bits: int
+    :return: the line; `(0, 0, 0)` if the points coincide
+
+    Example:
+        >>> join((0, 0, 1), (1, 1, 1))
+        (-1, 1, 0)
+    """
+    return reduce_content(cross(p, q), max_bits)
+
+
+def meet(l_1: Triple, l_2: Triple, max_bits: int = REDUCE_BITS) -> Triple:
+    """
+    The function `meet` computes the point on two lines.
+
+    :param l_1: The first line
+    :type l_1: Triple
+    :param l_2: The second line
+    :type l_2: Triple
+    :param max_bits: The entry size that triggers a content reduction of the result
+    :type max_bits: int
+    :return: the point, at infinity (`z == 0`) for parallel lines and `(0, 0, 0)` if the lines
+        coincide
+
+    Example:
+        >>> meet((1, 0, -1), (0, 1, -2))
+        (1, 2, 1)
+    """
+    return reduce_content(cross(l_1, l_2), max_bits)
+
+
+def join_batch(
+    ps: Sequence[Triple], qs: Sequence[Triple], max_bits: int = REDUCE_BITS
+) -> List[Triple]:
+    """The lines through corresponding points of two arrays"""
+    return [reduce_content(cross(p, q), max_bits) for p, q in zip(ps, qs)]
+
+
+def meet_batch(
+    ls: Sequence[Triple], ms: Sequence[Triple], max_bits: int = REDUCE_BITS
+) -> List[Triple]:
+    """The points on corresponding lines of two arrays"""
+    return [reduce_content(cross(l, m), max_bits) for l, m in zip(ls, ms)]
+
+
+def quadrance(p_1: Triple, p_2: Triple) -> Tuple[int, int]:
+    """
+    The function `quadrance` computes the quadrance between two finite points as an integer
+    numerator and denominator (not reduced).
+
+    Example:
+        >>> quadrance((0, 0, 1), (3, 4, 2))
+        (25, 4)
+    """
+    x_1, y_1, z_1 = p_1
+    x_2, y_2, z_2 = p_2
+    dx = x_1 * z_2 - x_2 * z_1
+    dy = y_1 * z_2 - y_2 * z_1
+    return dx * dx + dy * dy, (z_1 * z_2) ** 2
+
+
+def triangle_quadrances(
+    p_1: Triple, p_2: Triple, p_3: Triple
+) -> Tuple[int, int, int, int]:
+    """
+    The function `triangle_quadrances` computes the three quadrances of a triangle of finite
+    points over the common denominator `(z_1 z_2 z_3)^2`.
+
+    :return: `(n_1, n_2, n_3, d)`, where `n_i / d` is the quadrance opposite `p_i`
+    """
+    n_1, _ = quadrance(p_2, p_3)
+    n_2, _ = quadrance(p_1, p_3)
+    n_3, _ = quadrance(p_1, p_2)
+    z_1, z_2, z_3 = p_1[2] ** 2, p_2[2] ** 2, p_3[2] ** 2
+    return n_1 * z_1, n_2 * z_2, n_3 * z_3, z_1 * z_2 * z_3
+
+
+def quadrea(p_1: Triple, p_2: Triple, p_3: Triple) -> Tuple[int, int]:
+    """
+    The function `quadrea` computes the quadrea of a triangle of finite points as an integer
+    numerator and (positive) denominator; the points are collinear exactly when the numerator
+    is zero.
+
+    Example:
+        >>> quadrea((0, 0, 1), (1, 0, 1), (0, 1, 2))
+        (16, 16)
+        >>> quadrea((0, 0, 1), (1, 1, 1), (2, 2, 2))[0]
+        0
+    """
+    n_1, n_2, n_3, d = triangle_quadrances(p_1, p_2, p_3)
+    return archimedes(n_1, n_2, n_3), d * d
+
+
+def quadrea_batch(
+    p_1s: Sequence[Triple], p_2s: Sequence[Triple], p_3s: Sequence[Triple]
+) -> Tuple[List[int], List[int]]:
+    """
+    The function `quadrea_batch` computes the quadreas of many triangles.
+
+    :return: the columns of numerators and denominators
+    """
+    cols = [triangle_quadrances(*tri) for tri in zip(p_1s, p_2s, p_3s)]
+    nums = archimedes_batch(
+        [c[0] for c in cols], [c[1] for c in cols], [c[2] for c in cols]
+    )
+    return nums, [c[3] * c[3] for c in cols]
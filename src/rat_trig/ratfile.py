@@ -0,0 +1,383 @@
+"""
+A memory-mapped binary container for exact rational columns.
+
+A rat file stores named columns of rationals in chunks of rows, so results can be written
+as a stream and read back without any parsing. All integers are little-endian.
+
+Header::
+
+    magic     8 bytes   b"RATCOL\\x00\\x01" (format version 1)
+    ncols     uint32    number of columns
+    nbytes    uint32    length of the column names
+    names     nbytes    UTF-8 column names, separated by "\\n"
+    padding             zero bytes up to a multiple of 8
+
+Then any number of chunks, each::
+
+    nrows     int64     number of rows in the chunk
+    nover     int64     length of the overflow area in bytes, a multiple of 8
+    intmask   uint64    bit k set: every value of column k is an int64 integer
+    blocks              per column: nrows int64 numerators, then nrows int64 denominators
+    overflow  nover     the values that do not fit in int64
+
+A value `num / den` is stored in lowest terms with `den > 0`. A value that does not fit is
+stored with denominator slot 0, and its numerator slot holds the byte offset of the value in
+the overflow area of the chunk. There it is written as two signed integers, each as a LEB128
+varint byte count followed by that many bytes of big-endian two's complement.
+
+The mask has one bit per column, so a rat file has at most 64 columns.
+
+`RatReader` maps the file and gives zero-copy `memoryview` views of the int64 blocks. The
+batch functions of this package accept those views directly. `RatWriter` appends one chunk
+at a time.
+"""
+
+import mmap
+import struct
+import sys
+from array import array
+from fractions import Fraction
+from typing import Dict, Iterator, List, Mapping, Sequence, Tuple, Union
+
+from .batch_gcd import _coprime
+
+MAGIC = b"RATCOL\x00\x01"
+MAX_COLUMNS = 64
+_HEADER = struct.Struct("<8sII")
+_CHUNK = struct.Struct("<qqQ")
+_LITTLE = sys.byteorder == "little"
+
+Number = Union[int, Fraction]
+
+
+class RatFileError(ValueError):
+    """The file is not a valid rat file"""
+
+
+def _pad8(n: int) -> int:
+    return -n % 8
+
+
+def _varint(n: int) -> bytes:
+    out = bytearray()
+    while True:
+        byte, n = n & 0x7F, n >> 7
+        out.append(byte | 0x80 if n else byte)
+        if not n:
+            return bytes(out)
+
+
+def _read_varint(buf, pos: int) -> Tuple[int, int]:
+    n = shift = 0
+    while True:
+        byte = buf[pos]
+        pos += 1
+        n |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return n, pos
+
+
+def _encode_big(value: int) -> bytes:
+    data = value.to_bytes(value.bit_length() // 8 + 1, "big", signed=True)
+    return _varint(len(data)) + data
+
+
+def _decode_big(buf, pos: int) -> Tuple[int, int]:
+    size, pos = _read_varint(buf, pos)
+    if pos + size > len(buf):
+        raise IndexError("value past the end of the overflow area")
+    return int.from_bytes(buf[pos : pos + size], "big", signed=True), pos + size
+
+
+def _decode_overflow(buf, offset: int) -> Tuple[int, int]:
+    """The numerator and denominator stored at `offset` in an overflow area"""
+    try:
+        if offset < 0:
+            raise IndexError(offset)
+        num, pos = _decode_big(buf, offset)
+        den, _ = _decode_big(buf, pos)
+    except IndexError:
+        raise RatFileError(f"invalid overflow offset {offset}") from None
+    if den <= 0:
+        raise RatFileError(f"invalid denominator {den} in the overflow area")
+    return num, den
+
+
+def _le(values: array) -> bytes:
+    if not _LITTLE:  # pragma: no cover (big-endian hosts)
+        values = array(values.typecode, values)
+        values.byteswap()
+    return values.tobytes()
+
+
+def _encode_column(values: Sequence[Number], overflow: bytearray):
+    """The numerator and denominator blocks of a column, and whether it is all int64"""
+    if all(type(v) is int for v in values):
+        try:
+            return array("q", values), array("q", [1]) * len(values), True
+        except OverflowError:
+            pass
+    nums, dens = array("q"), array("q")
+    for v in values:
+        num, den = (v, 1) if isinstance(v, int) else (v.numerator, v.denominator)
+        if -(2**63) <= num < 2**63 and den < 2**63:
+            nums.append(num)
+            dens.append(den)
+        else:
+            nums.append(len(overflow))
+            dens.append(0)
+            overflow += _encode_big(num) + _encode_big(den)
+    return nums, dens, False
+
+
+class RatWriter:
+    """
+    Writes columns of rationals to a rat file, one chunk at a time.
+
+    Example:
+        >>> import tempfile, os
+        >>> path = os.path.join(tempfile.mkdtemp(), "q.rat")
+        >>> with RatWriter(path, ["q"]) as writer:
+        ...     writer.write_chunk({"q": [1, Fraction(2, 3), 2**70]})
+        >>> with RatReader(path) as reader:
+        ...     reader.read_all()
+        {'q': [Fraction(1, 1), Fraction(2, 3), Fraction(1180591620717411303424, 1)]}
+    """
+
+    def __init__(self, path, columns: Sequence[str]) -> None:
+        """
+        :param path: The file to create
+        :param columns: At most 64 column names, which must not contain newlines
+        :type columns: Sequence[str]
+        :raises RatFileError: for more than 64 columns
+        """
+        if any("\n" in name for name in columns):
+            raise ValueError("column names must not contain newlines")
+        if len(columns) > MAX_COLUMNS:
+            raise RatFileError(
+                f"{len(columns)} columns, but a rat file has at most {MAX_COLUMNS}"
+            )
+        self.columns = list(columns)
+        self.num_rows = 0
+        names = "\n".join(self.columns).encode()
+        self._file = open(path, "wb")
+        self._file.write(_HEADER.pack(MAGIC, len(self.columns), len(names)) + names)
+        self._file.write(bytes(_pad8(_HEADER.size + len(names))))
+
+    def write_chunk(self, columns: Mapping[str, Sequence[Number]]) -> None:
+        """
+        Append a chunk of rows.
+
+        :param columns: One sequence of `int` or `Fraction` values per column, by name, all
+            of the same length
+        """
+        cols = [columns[name] for name in self.columns]
+        nrows = len(cols[0]) if cols else 0
+        if any(len(c) != nrows for c in cols):
+            raise ValueError("columns differ in length")
+        overflow = bytearray()
+        blocks = []
+        mask = 0
+        for k, col in enumerate(cols):
+            nums, dens, is_int = _encode_column(col, overflow)
+            if is_int:
+                mask |= 1 << k
+            blocks += [_le(nums), _le(dens)]
+        overflow += bytes(_pad8(len(overflow)))
+        self._file.write(_CHUNK.pack(nrows, len(overflow), mask))
+        self._file.writelines(blocks)
+        self._file.write(overflow)
+        self.num_rows += nrows
+
+    def close(self) -> None:
+        self._file.close()
+
+    def __enter__(self) -> "RatWriter":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+
+class RatChunk:
+    """One chunk of a rat file, as zero-copy views into the mapped file"""
+
+    def __init__(
+        self, columns: List[str], nrows: int, mask: int, data, overflow
+    ) -> None:
+        self.columns = columns
+        self.num_rows = nrows
+        self._mask = mask
+        self._data = data
+        self._overflow = overflow
+
+    def _index(self, name: str) -> int:
+        try:
+            return self.columns.index(name)
+        except ValueError:
+            raise KeyError(name) from None
+
+    def blocks(self, name: str) -> Tuple[memoryview, memoryview]:
+        """
+        The raw numerator and denominator blocks of a column, as `memoryview` of format
+        `"q"`. A denominator of 0 marks a value stored in the overflow area.
+        """
+        k, n = self._index(name), self.num_rows
+        return (
+            self._data[2 * k * n : (2 * k + 1) * n],
+            self._data[(2 * k + 1) * n : (2 * k + 2) * n],
+        )
+
+    def is_integer(self, name: str) -> bool:
+        """Whether every value of the column is an int64 integer"""
+        return bool(self._mask >> self._index(name) & 1)
+
+    def integers(self, name: str) -> memoryview:
+        """A zero-copy view of an integer column"""
+        if not self.is_integer(name):
+            raise ValueError(f"column {name!r} is not an int64 integer column")
+        return self.blocks(name)[0]
+
+    def values(self, name: str) -> Union[memoryview, List[Fraction]]:
+        """
+        The values of a column: a zero-copy view for an integer column, and a list of
+        `Fraction` otherwise. The values are stored in lowest terms, so they are not reduced
+        again.
+
+        :raises RatFileError: if the chunk is corrupt
+        """
+        if self.is_integer(name):
+            return self.integers(name)
+        nums, dens = self.blocks(name)
+        if dens and min(dens) < 0:
+            raise RatFileError(f"negative denominator in column {name!r}")
+        if 0 not in dens:
+            return list(map(_coprime, nums.tolist(), dens.tolist()))
+        result = []
+        overflow = self._overflow
+        for num, den in zip(nums, dens):
+            if den == 0:
+                num, den = _decode_overflow(overflow, num)
+            result.append(_coprime(num, den))
+        return result
+
+
+class RatReader:
+    """Reads a rat file through a memory map"""
+
+    def __init__(self, path) -> None:
+        """
+        :param path: The file to read
+        :raises RatFileError: if the file is not a valid rat file
+        """
+        self._file = open(path, "rb")
+        size = self._file.seek(0, 2)
+        if size < _HEADER.size:
+            self._file.close()
+            raise RatFileError("file too short")
+        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        self._view = memoryview(self._map)
+        magic, ncols, nbytes = _HEADER.unpack_from(self._map, 0)
+        if magic != MAGIC:
+            self.close()
+            raise RatFileError("bad magic number")
+        start = _HEADER.size
+        names = bytes(self._view[start : start + nbytes]).decode()
+        self.columns = names.split("\n") if ncols else []
+        if len(self.columns) != ncols:
+            self.close()
+            raise RatFileError("column count does not match the names")
+        if ncols > MAX_COLUMNS:
+            self.close()
+            raise RatFileError(f"more than {MAX_COLUMNS} columns")
+        pos = start + nbytes
+        pos += _pad8(pos)
+        self._chunks = []
+        while pos < size:
+            if pos + _CHUNK.size > size:
+                self.close()
+                raise RatFileError("truncated chunk header")
+            nrows, nover, mask = _CHUNK.unpack_from(self._map, pos)
+            data = pos + _CHUNK.size
+            end = data + 16 * nrows * ncols + nover
+            if nrows < 0 or nover < 0 or end > size:
+                self.close()
+                raise RatFileError("truncated chunk")
+            self._chunks.append((nrows, mask, data, end - nover, end))
+            pos = end
+        self.num_rows = sum(c[0] for c in self._chunks)
+
+    def __len__(self) -> int:
+        return len(self._chunks)
+
+    def __iter__(self) -> Iterator[RatChunk]:
+        return (self.chunk(i) for i in range(len(self._chunks)))
+
+    def chunk(self, index: int) -> RatChunk:
+        if self._view is None:
+            raise ValueError("I/O operation on closed rat file")
+        nrows, mask, data, over, end = self._chunks[index]
+        view = self._view[data:over]
+        if _LITTLE:
+            blocks = view.cast("q")
+        else:  # pragma: no cover (big-endian hosts copy)
+            blocks = array("q", view)
+            blocks.byteswap()
+            blocks = memoryview(blocks)
+        return RatChunk(self.columns, nrows, mask, blocks, self._view[over:end])
+
+    def read_all(self) -> Dict[str, List[Fraction]]:
+        """All values of all columns as `Fraction` lists"""
+        result: Dict[str, List[Fraction]] = {name: [] for name in self.columns}
+        for chunk in self:
+            for name in self.columns:
+                values = chunk.values(name)
+                if isinstance(values, memoryview):
+                    values = list(map(Fraction, values.tolist()))
+                result[name] += values
+        return result
+
+    def close(self) -> None:
+        """
+        Close the file. Views of chunks that are still alive keep the memory map valid; it is
+        then unmapped when the last of them is released instead of now.
+        """
+        view, self._view = self._view, None
+        mapping, self._map = self._map, None
+        if view is not None:
+            view.release()
+        if mapping is not None:
+            try:
+                mapping.close()
+            except BufferError:
+                pass  # exported views hold the only references left
+        self._file.close()
+
+    def __enter__(self) -> "RatReader":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+
+def write_ratfile(
+    path, columns: Mapping[str, Sequence[Number]], chunk_size: int = 65536
+) -> int:
+    """
+    The function `write_ratfile` writes columns of rationals to a rat file.
+
+    :param path: The file to create
+    :param columns: One sequence of `int` or `Fraction` values per column, by name
+    :param chunk_size: The number of rows per chunk
+    :type chunk_size: int
+    :return: the number of rows written
+    """
+    names = list(columns)
+    nrows = len(columns[names[0]]) if names else 0
+    with RatWriter(path, names) as writer:
+        for start in range(0, nrows, chunk_size):
+            writer.write_chunk(
+                {n: columns[n][start : start + chunk_size] for n in names}
+            )
+    return nrows
@@ -0,0 +1,233 @@
+"""
+Exact rational rotations.
+
+A rotation of the plane has a rational matrix exactly when it is
+`[[a, -b], [b, a]] / c` for a Pythagorean triple `a^2 + b^2 = c^2`. `Rotation` keeps that
+triple in canonical form, `gcd(a, b, c) = 1` and `c > 0`, so equal rotations compare and hash
+equal. The height `c` is also the denominator of every coordinate it produces, which is what
+grows when rotations are composed.
+
+Composition multiplies the triples like Gaussian integers `(a + bi) / c`. `compose_all`
+postpones the gcd reduction of the intermediate products until their height passes a bit
+threshold, and `snap` replaces a rotation by a nearby one of bounded height.
+"""
+
+from fractions import Fraction
+from math import gcd, isqrt
+from typing import Iterable, List, Sequence, Tuple, Union
+
+Number = Union[int, Fraction]
+
+
+def _reduce(a: int, b: int, c: int) -> Tuple[int, int, int]:
+    g = gcd(gcd(a, b), c)
+    if c < 0:
+        g = -g
+    return a // g, b // g, c // g
+
+
+class Rotation:
+    """
+    A rotation with rational matrix `[[a, -b], [b, a]] / c`.
+
+    Example:
+        >>> r = Rotation(3, 4, 5)
+        >>> r * r
+        Rotation(-7, 24, 25)
+        >>> r * r.inverse() == Rotation.identity()
+        True
+        >>> r.apply([(5, 0), (0, 1)])
+        [(Fraction(3, 1), Fraction(4, 1)), (Fraction(-4, 5), Fraction(3, 5))]
+    """
+
+    __slots__ = ("a", "b", "c")
+
+    def __init__(self, a: int, b: int, c: int) -> None:
+        """
+        :param a: The cosine numerator
+        :type a: int
+        :param b: The sine numerator
+        :type b: int
+        :param c: The common denominator (height), nonzero
+        :type c: int
+        :raises ValueError: if `(a, b, c)` is not a Pythagorean triple
+        """
+        if c == 0 or a * a + b * b != c * c:
+            raise ValueError(f"({a}, {b}, {c}) is not a Pythagorean triple")
+        self.a, self.b, self.c = _reduce(a, b, c)
+
+    @classmethod
+    def _raw(cls, a: int, b: int, c: int) -> "Rotation":
+        """Construct from a reduced triple without checking"""
+        rot = cls.__new__(cls)
+        rot.a, rot.b, rot.c = a, b, c
+        return rot
+
+    @classmethod
+    def identity(cls) -> "Rotation":
+        return cls._raw(1, 0, 1)
+
+    @classmethod
+    def from_half_tangent(cls, t: Number) -> "Rotation":
+        """
+        The rotation by the angle `2 atan(t)`, i.e. `((1 - t^2) + 2t i) / (1 + t^2)`.
+
+        :param t: The rational tangent of half the rotation angle
+        :type t: Number
+        :return: the rotation
+
+        Example:
+            >>> Rotation.from_half_tangent(Fraction(1, 2))
+            Rotation(3, 4, 5)
+        """
+        t = Fraction(t)
+        p, q = t.numerator, t.denominator
+        return cls._raw(*_reduce(q * q - p * p, 2 * p * q, q * q + p * p))
+
+    def __repr__(self) -> str:
+        return f"Rotation({self.a}, {self.b}, {self.c})"
+
+    def __eq__(self, other) -> bool:
+        if not isinstance(other, Rotation):
+            return NotImplemented
+        return (self.a, self.b, self.c) == (other.a, other.b, other.c)
+
+    def __hash__(self) -> int:
+        return hash((self.a, self.b, self.c))
+
+    @property
+    def height(self) -> int:
+        return self.c
+
+    @property
+    def spread(self) -> Fraction:
+        """The spread of the rotation, the squared sine of its angle"""
+        return Fraction(self.b * self.b, self.c * self.c)
+
+    def inverse(self) -> "Rotation":
+        return Rotation._raw(self.a, -self.b, self.c)
+
+    def __mul__(self, other: "Rotation") -> "Rotation":
+        """Composition; rotations of the plane commute"""
+        if not isinstance(other, Rotation):
+            return NotImplemented
+        return Rotation._raw(
+            *_reduce(
+                self.a * other.a - self.b * other.b,
+                self.a * other.b + self.b * other.a,
+                self.c * other.c,
+            )
+        )
+
+    def apply(
+        self, points: Iterable[Sequence[Number]]
+    ) -> List[Tuple[Fraction, Fraction]]:
+        """
+        Rotate a whole array of points in one call.
+
+        :param points: The points as `(x, y)` pairs of `int` or `Fraction`
+        :type points: Iterable[Sequence[Number]]
+        :return: the rotated points
+        """
+        a, b, c = self.a, self.b, self.c
+        return [
+            (Fraction(a * x - b * y, c), Fraction(b * x + a * y, c)) for x, y in points
+        ]
+
+    def apply_scaled(
+        self, xs: Sequence[int], ys: Sequence[int]
+    ) -> Tuple[List[int], List[int], int]:
+        """
+        Rotate integer points without any gcd: the results share the denominator `c`.
+
+        :param xs: The x-coordinates
+        :type xs: Sequence[int]
+        :param ys: The y-coordinates
+        :type ys: Sequence[int]
+        :return: the numerators of the rotated x- and y-coordinates and their denominator
+        """
+        a, b = self.a, self.b
+        return (
+            [a * x - b * y for x, y in zip(xs, ys)],
+            [b * x + a * y for x, y in zip(xs, ys)],
+            self.c,
+        )
+
+    def snap(self, max_height: int) -> "Rotation":
+        """
+        A nearby rotation of height at most `max_height`. The half-angle tangent
+        `t = b / (a + c)` (or its reciprocal, whichever is at most one in magnitude) is replaced
+        by its best rational approximation `p / q` under the height bound, using continued
+        fractions; the height of `p / q` is `p^2 + q^2`, halved when both are odd.
+
+        :param max_height: The height bound, at least 1
+        :type max_height: int
+        :return: the snapped rotation; the rotation itself if it is already low enough
+
+        Example:
+            >>> Rotation(20, 99, 101).snap(30)
+            Rotation(7, 24, 25)
+        """
+        if self.c <= max_height:
+            return self
+        if max_height < 1:
+            raise ValueError("max_height must be at least 1")
+        # b != 0 here, since the only rotations with b == 0 have height 1
+        flip = abs(self.b) > self.a + self.c
+        target = (
+            Fraction(self.a + self.c, self.b)
+            if flip
+            else Fraction(self.b, self.a + self.c)
+        )
+        best = _best_half_tangent(target, max_height)
+        p, q = best.numerator, best.denominator
+        if not flip:
+            return Rotation._raw(*_reduce(q * q - p * p, 2 * p * q, q * q + p * p))
+        # the half-angle tangent is q / p
+        return Rotation._raw(*_reduce(p * p - q * q, 2 * p * q, p * p + q * q))
+
+
+def _height(p: int, q: int) -> int:
+    h = p * p + q * q
+    return h // 2 if p % 2 and q % 2 else h
+
+
+def _best_half_tangent(target: Fraction, max_height: int) -> Fraction:
+    """The closest `p / q` to `target` (of magnitude at most 1) with `_height(p, q) <= max_height`"""
+    best = Fraction(0)
+    floor = 0
+    # the height is about q^2 (1 + target^2), or half of it when p and q are both odd
+    for limit in (max_height, 2 * max_height):
+        den = isqrt(int(limit / (1 + target * target)))
+        while den > floor:
+            approx = target.limit_denominator(den)
+            if _height(approx.numerator, approx.denominator) <= max_height:
+                if abs(approx - target) < abs(best - target):
+                    best = approx
+                break
+            den = approx.denominator - 1
+        floor = isqrt(int(max_height / (1 + target * target)))
+    return best
+
+
+def compose_all(rotations: Iterable[Rotation], max_bits: int = 256) -> Rotation:
+    """
+    The function `compose_all` composes a sequence of rotations, reducing the accumulated triple
+    by its content only when its height grows past `max_bits` bits and once at the end.
+
+    :param rotations: The rotations to compose
+    :type rotations: Iterable[Rotation]
+    :param max_bits: The height in bits that triggers an intermediate gcd reduction
+    :type max_bits: int
+    :return: the composed rotation in canonical form
+
+    Example:
+        >>> compose_all([Rotation(3, 4, 5)] * 4)
+        Rotation(-527, -336, 625)
+    """
+    a, b, c = 1, 0, 1
+    for rot in rotations:
+        a, b, c = a * rot.a - b * rot.b, a * rot.b + b * rot.a, c * rot.c
+        if c.bit_length() > max_bits:
+            a, b, c = _reduce(a, b, c)
+    return Rotation._raw(*_reduce(a, b, c))
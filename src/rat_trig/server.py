@@ -0,0 +1,426 @@
+"""
+A local batching service that coalesces small `archimedes` requests.
+
+Many callers with one or a few triangles each pay the per-call overhead of Python. The
+server collects the requests that arrive within a short deadline, 200 µs by default, and
+evaluates them as one `archimedes_batch` call. It listens on a Unix domain socket or a
+localhost TCP port (`rat-trig serve`).
+
+Protocol
+--------
+All integers are little-endian. Every request and every response is one frame::
+
+    length    uint32    number of bytes after this field
+    id        uint32    request id, echoed in the response
+    kind      uint8     request: 0 int64 quadrances, 1 rational quadrances, 2 metrics
+                        response: 0 ok, 1 error
+    count     uint32    number of triangles (request) or results (response)
+    payload
+
+Request payloads are columns of int64, not rows. Kind 0 holds `q_1[count]`, `q_2[count]`,
+`q_3[count]`. Kind 1 holds the numerators and denominators `n_1, d_1, n_2, d_2, n_3, d_3`,
+each `[count]` long. Kind 2 has no payload.
+
+An ok response to kind 0 holds `count` quadreas. A response to kind 1 holds a numerator and
+a denominator per result. Each integer is encoded as in the overflow area of
+`rat_trig.ratfile`: a varint byte count, then big-endian two's complement bytes. The response
+to kind 2 is a UTF-8 JSON object of metrics, and an error response holds a UTF-8 message.
+
+A frame is at most `MAX_FRAME` bytes long. The server reads no further requests from a
+connection while it has `MAX_IN_FLIGHT` of them unanswered, and waits for every reply to be
+drained to the client, so a client that does not read its replies cannot make the server
+buffer without bound.
+"""
+
+import asyncio
+import itertools
+import json
+import socket
+import struct
+import sys
+from array import array
+from fractions import Fraction
+from typing import Dict, List, NamedTuple, Optional, Sequence, Tuple, Union
+
+from .batch_gcd import to_fractions
+from .ratfile import _decode_big, _encode_big
+from .trigonom import archimedes_batch
+
+INT64, RATIONAL, METRICS = 0, 1, 2
+OK, ERROR = 0, 1
+FRAME = struct.Struct("<IIBI")
+MAX_FRAME = 1 << 26
+MAX_IN_FLIGHT = 64
+_LITTLE = sys.byteorder == "little"
+
+Number = Union[int, Fraction]
+
+
+class ServerMetrics:
+    """Counters of a `BatchServer`"""
+
+    def __init__(self) -> None:
+        self.requests = 0
+        self.triangles = 0
+        self.batches = 0
+        self.max_queue_depth = 0
+        self.batch_sizes: Dict[int, int] = {}  # power-of-two bucket: number of batches
+
+    def record_batch(self, size: int) -> None:
+        self.batches += 1
+        bucket = 1 << max(size - 1, 0).bit_length()
+        self.batch_sizes[bucket] = self.batch_sizes.get(bucket, 0) + 1
+
+    def snapshot(self, queue_depth: int = 0) -> dict:
+        return {
+            "requests": self.requests,
+            "triangles": self.triangles,
+            "batches": self.batches,
+            "queue_depth": queue_depth,
+            "max_queue_depth": self.max_queue_depth,
+            "mean_batch_size": self.triangles / self.batches if self.batches else 0.0,
+            "batch_sizes": {str(k): v for k, v in sorted(self.batch_sizes.items())},
+        }
+
+
+class _Pending(NamedTuple):
+    kind: int
+    columns: Tuple[Sequence[Number], Sequence[Number], Sequence[Number]]
+    count: int
+    future: "asyncio.Future[List[Number]]"
+
+
+def _int64_columns(payload: bytes, ncols: int, count: int) -> List[array]:
+    if len(payload) != 8 * ncols * count:
+        raise ValueError(
+            f"expected {8 * ncols * count} payload bytes, got {len(payload)}"
+        )
+    data = array("q", payload)
+    if not _LITTLE:  # pragma: no cover (big-endian hosts)
+        data.byteswap()
+    return [data[k * count : (k + 1) * count] for k in range(ncols)]
+
+
+def decode_request(kind: int, count: int, payload: bytes) -> Tuple[Sequence, ...]:
+    """The three quadrance columns of a request payload"""
+    if kind == INT64:
+        return tuple(_int64_columns(payload, 3, count))
+    if kind == RATIONAL:
+        cols = _int64_columns(payload, 6, count)
+        if any(0 in cols[k] for k in (1, 3, 5)):
+            raise ValueError("zero denominator")
+        return tuple(to_fractions(cols[k], cols[k + 1]) for k in (0, 2, 4))
+    raise ValueError(f"unknown request kind {kind}")
+
+
+def encode_results(kind: int, results: Sequence[Number]) -> bytes:
+    """The payload of an ok response"""
+    if kind == INT64:
+        return b"".join(map(_encode_big, results))
+    return b"".join(
+        _encode_big(r.numerator) + _encode_big(r.denominator) for r in results
+    )
+
+
+def decode_results(kind: int, count: int, payload: bytes) -> List[Number]:
+    """The results of an ok response payload"""
+    results: List[Number] = []
+    pos = 0
+    for _ in range(count):
+        num, pos = _decode_big(payload, pos)
+        if kind == RATIONAL:
+            den, pos = _decode_big(payload, pos)
+            results.append(Fraction(num, den))
+        else:
+            results.append(num)
+    return results
+
+
+def encode_request(
+    request_id: int,
+    q_1s: Sequence[Number],
+    q_2s: Sequence[Number],
+    q_3s: Sequence[Number],
+) -> Tuple[int, bytes]:
+    """
+    The function `encode_request` encodes the quadrances of some triangles as a request
+    frame, of kind `INT64` if all are `int` and `RATIONAL` otherwise.
+
+    :return: the kind and the frame
+    """
+    count = len(q_1s)
+    if all(type(q) is int for col in (q_1s, q_2s, q_3s) for q in col):
+        kind = INT64
+        data = array("q", itertools.chain(q_1s, q_2s, q_3s))
+    else:
+        kind = RATIONAL
+        data = array("q")
+        for col in (q_1s, q_2s, q_3s):
+            fracs = [Fraction(q) for q in col]
+            data.extend(f.numerator for f in fracs)
+            data.extend(f.denominator for f in fracs)
+    if not _LITTLE:  # pragma: no cover (big-endian hosts)
+        data.byteswap()
+    payload = data.tobytes()
+    header = FRAME.pack(FRAME.size - 4 + len(payload), request_id, kind, count)
+    return kind, header + payload
+
+
+async def read_frame(reader: asyncio.StreamReader) -> Tuple[int, int, int, bytes]:
+    """Read one frame; returns its id, kind or status, count and payload"""
+    header = await reader.readexactly(FRAME.size)
+    length, frame_id, kind, count = FRAME.unpack(header)
+    if not FRAME.size - 4 <= length <= MAX_FRAME:
+        raise ValueError(f"invalid frame length {length}")
+    payload = await reader.readexactly(length - (FRAME.size - 4))
+    return frame_id, kind, count, payload
+
+
+def _frame(frame_id: int, status: int, count: int, payload: bytes) -> bytes:
+    return FRAME.pack(FRAME.size - 4 + len(payload), frame_id, status, count) + payload
+
+
+class BatchServer:
+    """
+    A server that evaluates `archimedes` for coalesced requests.
+
+    Example:
+        >>> async def demo():
+        ...     server = await BatchServer.start(port=0)
+        ...     reader, writer = await asyncio.open_connection(*server.address)
+        ...     _, frame = encode_request(7, [2, 1], [4, 1], [6, 4])
+        ...     writer.write(frame)
+        ...     request_id, status, count, payload = await read_frame(reader)
+        ...     writer.close()
+        ...     await server.close()
+        ...     return request_id, decode_results(INT64, count, payload)
+        >>> asyncio.run(demo())
+        (7, [32, 0])
+    """
+
+    def __init__(self, deadline: float = 200e-6, max_batch: int = 65536) -> None:
+        """
+        :param deadline: The longest time in seconds that a request waits for others to
+            join its batch
+        :type deadline: float
+        :param max_batch: The number of triangles that closes a batch before the deadline
+        :type max_batch: int
+        """
+        self.deadline = deadline
+        self.max_batch = max_batch
+        self.metrics = ServerMetrics()
+        self.address: Union[str, Tuple[str, int], None] = None
+        self._queue: "Optional[asyncio.Queue[_Pending]]" = None
+        self._server: Optional[asyncio.AbstractServer] = None
+        self._worker: "Optional[asyncio.Task[None]]" = None
+
+    @classmethod
+    async def start(
+        cls,
+        path: Optional[str] = None,
+        host: str = "127.0.0.1",
+        port: int = 0,
+        deadline: float = 200e-6,
+        max_batch: int = 65536,
+    ) -> "BatchServer":
+        """
+        Start a server on a Unix domain socket at `path`, or else on a TCP port of `host`.
+
+        :param port: The TCP port, 0 for any free port; see `address` for the bound one
+        """
+        self = cls(deadline, max_batch)
+        self._queue = asyncio.Queue()
+        self._worker = asyncio.ensure_future(self._coalesce())
+        if path is not None:
+            self._server = await asyncio.start_unix_server(self._handle, path)
+            self.address = path
+        else:
+            self._server = await asyncio.start_server(self._handle, host, port)
+            self.address = self._server.sockets[0].getsockname()[:2]
+        return self
+
+    @property
+    def queue_depth(self) -> int:
+        """The number of requests waiting for a batch"""
+        return self._queue.qsize() if self._queue is not None else 0
+
+    async def serve_forever(self) -> None:
+        await self._server.serve_forever()
+
+    async def close(self) -> None:
+        self._server.close()
+        await self._server.wait_closed()
+        self._worker.cancel()
+        try:
+            await self._worker
+        except asyncio.CancelledError:
+            pass
+
+    async def evaluate(
+        self, kind: int, columns: Tuple[Sequence, ...], count: int
+    ) -> List[Number]:
+        """Queue the quadrance columns of one request and wait for their batch"""
+        future = asyncio.get_running_loop().create_future()
+        self._queue.put_nowait(_Pending(kind, columns, count, future))
+        self.metrics.requests += 1
+        self.metrics.max_queue_depth = max(
+            self.metrics.max_queue_depth, self.queue_depth
+        )
+        return await future
+
+    async def _coalesce(self) -> None:
+        loop = asyncio.get_running_loop()
+        while True:
+            batch = [await self._queue.get()]
+            rows = batch[0].count
+            end = loop.time() + self.deadline
+            while rows < self.max_batch:
+                try:
+                    item = self._queue.get_nowait()
+                except asyncio.QueueEmpty:
+                    remaining = end - loop.time()
+                    if remaining <= 0:
+                        break
+                    try:
+                        item = await asyncio.wait_for(self._queue.get(), remaining)
+                    except asyncio.TimeoutError:
+                        break
+                batch.append(item)
+                rows += item.count
+            self._evaluate(batch)
+
+    def _evaluate(self, batch: List[_Pending]) -> None:
+        for kind in (INT64, RATIONAL):
+            group = [p for p in batch if p.kind == kind and not p.future.done()]
+            if not group:
+                continue
+            columns = [
+                list(itertools.chain.from_iterable(p.columns[k] for p in group))
+                for k in range(3)
+            ]
+            try:
+                results = archimedes_batch(*columns)
+            except Exception as err:  # pragma: no cover (defensive)
+                for p in group:
+                    p.future.set_exception(err)
+                continue
+            self.metrics.record_batch(len(results))
+            self.metrics.triangles += len(results)
+            start = 0
+            for p in group:
+                p.future.set_result(results[start : start + p.count])
+                start += p.count
+
+    async def _handle(
+        self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter
+    ) -> None:
+        tasks = set()
+        slots = asyncio.Semaphore(MAX_IN_FLIGHT)
+        lock = asyncio.Lock()  # one drain at a time, as older Pythons require
+        try:
+            while True:
+                await slots.acquire()
+                try:
+                    frame_id, kind, count, payload = await read_frame(reader)
+                except (asyncio.IncompleteReadError, ConnectionError):
+                    break
+                except ValueError as err:
+                    writer.write(_frame(0, ERROR, 0, str(err).encode()))
+                    break
+                task = asyncio.ensure_future(
+                    self._respond(writer, lock, frame_id, kind, count, payload)
+                )
+                tasks.add(task)
+                task.add_done_callback(tasks.discard)
+                task.add_done_callback(lambda _: slots.release())
+            if tasks:
+                await asyncio.gather(*tasks, return_exceptions=True)
+        finally:
+            writer.close()
+
+    async def _respond(
+        self,
+        writer: asyncio.StreamWriter,
+        lock: asyncio.Lock,
+        frame_id: int,
+        kind: int,
+        count: int,
+        payload: bytes,
+    ) -> None:
+        try:
+            if kind == METRICS:
+                body = json.dumps(self.metrics.snapshot(self.queue_depth)).encode()
+                reply = _frame(frame_id, OK, 0, body)
+            else:
+                columns = decode_request(kind, count, payload)
+                results = await self.evaluate(kind, columns, count)
+                reply = _frame(frame_id, OK, count, encode_results(kind, results))
+        except Exception as err:
+            # every request gets a reply, or the client would wait for it forever
+            message = str(err) or type(err).__name__
+            reply = _frame(frame_id, ERROR, 0, message.encode())
+        async with lock:
+            writer.write(reply)
+            try:
+                await writer.drain()
+            except ConnectionError:
+                pass  # the client is gone; `_handle` closes the connection
+
+
+class Client:
+    """
+    A blocking client of a `BatchServer`.
+
+    :param address: A Unix socket path, or a `(host, port)` pair
+    """
+
+    def __init__(self, address: Union[str, Tuple[str, int]]) -> None:
+        if isinstance(address, str):
+            self._sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        else:
+            self._sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            self._sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self._sock.connect(address)
+        self._ids = itertools.count(1)
+
+    def _recv_exactly(self, size: int) -> bytes:
+        chunks = []
+        while size:
+            chunk = self._sock.recv(size)
+            if not chunk:
+                raise ConnectionError("connection closed by the server")
+            chunks.append(chunk)
+            size -= len(chunk)
+        return b"".join(chunks)
+
+    def _call(self, frame: bytes) -> Tuple[int, int, bytes]:
+        self._sock.sendall(frame)
+        length, _, status, count = FRAME.unpack(self._recv_exactly(FRAME.size))
+        payload = self._recv_exactly(length - (FRAME.size - 4))
+        if status != OK:
+            raise ValueError(payload.decode())
+        return status, count, payload
+
+    def archimedes(
+        self, q_1s: Sequence[Number], q_2s: Sequence[Number], q_3s: Sequence[Number]
+    ) -> List[Number]:
+        """The quadreas of some triangles, evaluated by the server"""
+        kind, frame = encode_request(next(self._ids) & 0xFFFFFFFF, q_1s, q_2s, q_3s)
+        _, count, payload = self._call(frame)
+        return decode_results(kind, count, payload)
+
+    def metrics(self) -> dict:
+        """The metrics of the server"""
+        _, _, payload = self._call(
+            _frame(next(self._ids) & 0xFFFFFFFF, METRICS, 0, b"")
+        )
+        return json.loads(payload)
+
+    def close(self) -> None:
+        self._sock.close()
+
+    def __enter__(self) -> "Client":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
@@ -1,30 +1,71 @@
 """
-This is a skeleton file that can serve as a starting point for a Python
-console script. To run this script uncomment the following lines in the
-``[options.entry_points]`` section in ``setup.cfg``::
-
-    console_scripts =
-         fibonacci = rat_trig.skeleton:run
-
-Then run ``pip install .`` (or ``pip install -e .`` for editable mode)
-which will install the command ``fibonacci`` inside your current environment.
-
-Besides console scripts, the header (i.e. until ``_logger``...) of this file can
-also be used as template for Python modules.
-
-Note:
-    This file can be renamed depending on your needs or safely removed if not needed.
-
-References:
-    - https://setuptools.pypa.io/en/latest/userguide/entry_point.html
-    - https://pip.pypa.io/en/stable/reference/pip_install
+The ``rat-trig`` console script: streaming evaluation of rational trigonometry formulas.
+
+It reads triangles from CSV or TSV files (or stdin), one per row, given either by their
+three quadrances ``q_1, q_2, q_3`` or by the coordinates ``x_1, y_1, x_2, y_2, x_3, y_3`` of
+their vertices, and writes one row of results per triangle::
+
+    $ printf '1,1,4\\n2,4,6\\n' | rat-trig -f quadrea -f spread_3
+    quadrea,spread_3
+    0,0
+    32,1
+
+The input is processed in chunks of ``--chunk-size`` rows: each chunk is converted to columns
+of the selected numeric type and evaluated by one compiled :mod:`rat_trig.expr` program, so
+the whole input is never held in memory. Files with the suffix ``.rat`` are read as binary
+:mod:`rat_trig.ratfile` containers with columns named ``q_1, q_2, q_3`` (or ``x_1, ...``),
+which needs no parsing at all. With ``--jobs N``, CSV/TSV files are split into byte ranges
+that are evaluated by ``N`` worker processes and written back in input order. With
+``--native-parse``, CSV/TSV input is tokenized by the C tokenizer of :mod:`rat_trig.parse`
+when a C compiler is available.
+
+``rat-trig serve`` instead runs a :mod:`rat_trig.server` that answers quadrea requests on a
+Unix domain socket (``--unix PATH``) or a localhost TCP port (``--port N``), batching the
+requests that arrive within ``--deadline-us`` microseconds. The entry point is defined in the
+``[options.entry_points]`` section of ``setup.cfg``; the module can also be run with
+``python -m rat_trig.skeleton``.
 """
 
 import argparse
+import asyncio
+import collections
+import contextlib
+import io
+import itertools
 import logging
+import os
 import sys
+import time
+from concurrent.futures import Future, ProcessPoolExecutor
+from fractions import Fraction
+from typing import (
+    ContextManager,
+    Deque,
+    Dict,
+    Iterable,
+    Iterator,
+    List,
+    Mapping,
+    Sequence,
+    TextIO,
+    Tuple,
+)
 
 from rat_trig import __version__
+from rat_trig.checkpoint import (
+    Checkpoint,
+    CheckpointError,
+    fingerprint,
+    load_checkpoint,
+    remove_checkpoint,
+    save_checkpoint,
+)
+from rat_trig.expr import Program, compile_exprs, var
+from rat_trig.fmt import STYLES, format_rows
+from rat_trig.parse import KINDS, ParseError, iter_chunks
+from rat_trig.ratfile import RatReader, RatWriter
+from rat_trig.server import BatchServer
+from rat_trig.trigonom import archimedes, quadrance
 
 __author__ = "Wai-Shing Luk"
 __copyright__ = "Wai-Shing Luk"
@@ -32,28 +73,501 @@ __license__ = "MIT"
 
 _logger = logging.getLogger(__name__)
 
+TYPES = KINDS
+FORMULAS = (
+    "q_1",
+    "q_2",
+    "q_3",
+    "quadrea",
+    "spread_1",
+    "spread_2",
+    "spread_3",
+    "circumquadrance",
+)
+INPUT_COLUMNS = {
+    "quadrances": ("q_1", "q_2", "q_3"),
+    "coords": ("x_1", "y_1", "x_2", "y_2", "x_3", "y_3"),
+}
+
 
 # ---- Python API ----
 # The functions defined in this section can be imported by users in their
 # Python scripts/interactive interpreter, e.g. via
-# `from rat_trig.skeleton import fib`,
+# `from rat_trig.skeleton import build_program`,
 # when using this Python module as a library.
 
 
-def fib(n):
-    """Fibonacci example function
+def build_program(formulas: Sequence[str], inputs: str = "quadrances") -> Program:
+    """Compile the named formulas for one kind of input rows
+
+    Args:
+      formulas (Sequence[str]): names from :data:`FORMULAS`
+      inputs (str): ``"quadrances"`` or ``"coords"``
+
+    Returns:
+      :obj:`rat_trig.expr.Program`: the program, whose variables are the input columns
+    """
+    if inputs == "coords":
+        x_1, y_1, x_2, y_2, x_3, y_3 = map(var, INPUT_COLUMNS["coords"])
+        q_1 = quadrance((x_2, y_2), (x_3, y_3))
+        q_2 = quadrance((x_1, y_1), (x_3, y_3))
+        q_3 = quadrance((x_1, y_1), (x_2, y_2))
+    else:
+        q_1, q_2, q_3 = map(var, INPUT_COLUMNS["quadrances"])
+    quadrea = archimedes(q_1, q_2, q_3)
+    table = {
+        "q_1": q_1,
+        "q_2": q_2,
+        "q_3": q_3,
+        "quadrea": quadrea,
+        "spread_1": quadrea / (4 * q_2 * q_3),
+        "spread_2": quadrea / (4 * q_1 * q_3),
+        "spread_3": quadrea / (4 * q_1 * q_2),
+        "circumquadrance": q_1 * q_2 * q_3 / quadrea,
+    }
+    return compile_exprs({name: table[name] for name in formulas})
+
+
+def has_division(program: Program) -> bool:
+    """Whether evaluating the program divides, which ``int`` inputs cannot do exactly"""
+    return any(node.op == "/" for node in program.nodes)
+
+
+def evaluate_columns(
+    program: Program,
+    columns: Sequence[Sequence],
+    names: Sequence[str] = INPUT_COLUMNS["quadrances"],
+) -> Dict[str, List]:
+    """Evaluate a program on a chunk of input columns
 
     Args:
-      n (int): integer
+      program (:obj:`rat_trig.expr.Program`): the compiled formulas
+      columns (Sequence[Sequence]): the input columns, in row order
+      names (Sequence[str]): the variable names of the columns
 
     Returns:
-      int: n-th Fibonacci number
+      Dict[str, List]: one column of results per formula
     """
-    assert n > 0
-    a, b = 1, 1
-    for _i in range(n - 1):
-        a, b = b, a + b
-    return a
+    used = set(program.variables)
+    return program(**{n: c for n, c in zip(names, columns) if n in used})
+
+
+def write_results(
+    out,
+    results: Mapping[str, Sequence],
+    style: str = "fraction",
+    digits: int = 6,
+    delimiter: str = ",",
+) -> None:
+    """Write one chunk of results as delimited text, or to a binary container
+
+    Args:
+      out: a text stream, or an object with a ``write_chunk`` method such as
+          :obj:`rat_trig.ratfile.RatWriter`
+      results (Mapping[str, Sequence]): one column of results per formula
+      style (str): the text format, a key of :data:`rat_trig.fmt.STYLES`
+      digits (int): the number of digits after the point for the decimal and scientific
+          styles
+      delimiter (str): the output field separator
+    """
+    if hasattr(out, "write_chunk"):
+        out.write_chunk(results)
+    else:
+        out.write(format_rows(results.values(), style, digits, delimiter))
+
+
+def _write_header(out, names: Iterable[str], delimiter: str) -> None:
+    if not hasattr(out, "write_chunk"):
+        out.write(delimiter.join(names) + "\n")
+
+
+def process_stream(
+    lines: Iterable[str],
+    program: Program,
+    kind: str,
+    out: TextIO,
+    names: Sequence[str] = INPUT_COLUMNS["quadrances"],
+    chunk_size: int = 65536,
+    delimiter: str = "",
+    out_delimiter: str = ",",
+    header: bool = True,
+    first_line: int = 1,
+    style: str = "fraction",
+    digits: int = 6,
+    native: bool = False,
+) -> int:
+    """Evaluate a program over a stream of CSV/TSV lines, chunk by chunk, and write CSV
+    results
+
+    Args:
+      lines (Iterable[str]): the input lines; blank lines and ``#`` comments are skipped
+      program (:obj:`rat_trig.expr.Program`): the compiled formulas
+      kind (str): the numeric type, a key of :data:`TYPES`
+      out: the output text stream or :obj:`rat_trig.ratfile.RatWriter`
+      names (Sequence[str]): the variable names of the input fields, in row order
+      chunk_size (int): the number of rows evaluated at once
+      delimiter (str): the input field separator; by default a tab if the first
+          line contains one, and a comma otherwise
+      out_delimiter (str): the output field separator
+      header (bool): whether to write a header row of formula names
+      first_line (int): the line number of the first line, for error messages
+      style (str): the text format, a key of :data:`rat_trig.fmt.STYLES`
+      digits (int): the number of digits after the point for the decimal and scientific
+          styles
+      native (bool): try the C tokenizer of :mod:`rat_trig.parse` first
+
+    Returns:
+      int: the number of rows processed
+
+    Raises:
+      :obj:`rat_trig.parse.ParseError`: for a malformed input line
+    """
+    if header:
+        _write_header(out, program.outputs, out_delimiter)
+    count = 0
+    chunks = iter_chunks(
+        lines, len(names), kind, delimiter, chunk_size, first_line, native
+    )
+    for columns in chunks:
+        rows = len(columns[0])
+        try:
+            results = evaluate_columns(program, columns, names)
+        except ZeroDivisionError as err:
+            raise ValueError(f"in rows {count + 1}-{count + rows}: {err}") from err
+        write_results(out, results, style, digits, out_delimiter)
+        count += rows
+        _logger.debug("processed %d rows", count)
+    return count
+
+
+def process_ratfile(
+    path,
+    program: Program,
+    kind: str,
+    out: TextIO,
+    delimiter: str = ",",
+    header: bool = True,
+    style: str = "fraction",
+    digits: int = 6,
+) -> int:
+    """Evaluate a program over the chunks of a :mod:`rat_trig.ratfile` file, whose columns
+    are named after the program variables, and write CSV results
+
+    Integer columns are passed to the program as zero-copy views, so no parsing is needed.
+
+    Args:
+      path: the rat file
+      program (:obj:`rat_trig.expr.Program`): the compiled formulas
+      kind (str): the numeric type, a key of :data:`TYPES`
+      out: the output text stream or :obj:`rat_trig.ratfile.RatWriter`
+      delimiter (str): the output field separator
+      header (bool): whether to write a header row of formula names
+      style (str): the text format, a key of :data:`rat_trig.fmt.STYLES`
+      digits (int): the number of digits after the point for the decimal and scientific
+          styles
+
+    Returns:
+      int: the number of rows processed
+    """
+    if header:
+        _write_header(out, program.outputs, delimiter)
+    exact_division = kind == "fraction" and has_division(program)
+    count = 0
+    with RatReader(path) as reader:
+        missing = set(program.variables) - set(reader.columns)
+        if missing:
+            raise ValueError(f"{path}: missing columns {', '.join(sorted(missing))}")
+        for chunk in reader:
+            columns = {}
+            for name in program.variables:
+                if kind == "int" and not chunk.is_integer(name):
+                    raise ValueError(f"{path}: column {name} is not an integer column")
+                values = chunk.values(name)
+                if kind == "float":
+                    values = list(map(float, values))
+                elif exact_division and isinstance(values, memoryview):
+                    values = list(map(Fraction, values.tolist()))
+                columns[name] = values
+            try:
+                results = program(**columns)
+            except ZeroDivisionError as err:
+                raise ValueError(f"in rows {count + 1}-{count + chunk.num_rows}: {err}")
+            write_results(out, results, style, digits, delimiter)
+            count += chunk.num_rows
+    return count
+
+
+def byte_ranges(path, chunk_bytes: int = 1 << 22) -> Iterator[Tuple[int, int]]:
+    """Split a file into byte ranges of about ``chunk_bytes`` that end on line boundaries
+
+    Args:
+      path: the file
+      chunk_bytes (int): the target size of a range
+
+    Returns:
+      Iterator[Tuple[int, int]]: the ``(start, end)`` offsets, covering the whole file
+    """
+    with open(path, "rb") as stream:
+        size = stream.seek(0, 2)
+        start = 0
+        while start < size:
+            end = min(start + chunk_bytes, size)
+            if end < size:
+                stream.seek(end)
+                stream.readline()
+                end = stream.tell()
+            yield start, end
+            start = end
+
+
+_WORKER: Dict[str, object] = {}
+
+
+class _Chunks(list):
+    """Collects result chunks in a worker for binary output"""
+
+    write_chunk = list.append
+
+
+def _init_worker(
+    formulas, inputs, kind, delimiter, out_delimiter, style, digits, binary, native
+):
+    _WORKER.update(
+        program=build_program(formulas, inputs),
+        names=INPUT_COLUMNS[inputs],
+        kind=kind,
+        delimiter=delimiter,
+        out_delimiter=out_delimiter,
+        style=style,
+        digits=digits,
+        binary=binary,
+        native=native,
+    )
+
+
+def _process_range(path, start: int, end: int) -> Tuple[int, object, int]:
+    """Read, evaluate and format one byte range in a worker process
+
+    Returns the number of rows, the output text (or the result chunks for binary output)
+    and the number of lines of the range; line numbers in errors are relative to the start
+    of the range. Lines are split like the serial reader splits them, on ``"\n"``,
+    ``"\r\n"`` and ``"\r"`` only.
+    """
+    with open(path, "rb") as stream:
+        stream.seek(start)
+        data = stream.read(end - start)
+    lines = io.StringIO(data.decode(), newline="").readlines()
+    out = _Chunks() if _WORKER["binary"] else io.StringIO()
+    count = process_stream(
+        lines,
+        _WORKER["program"],
+        _WORKER["kind"],
+        out,
+        _WORKER["names"],
+        delimiter=_WORKER["delimiter"],
+        out_delimiter=_WORKER["out_delimiter"],
+        header=False,
+        style=_WORKER["style"],
+        digits=_WORKER["digits"],
+        native=_WORKER["native"],
+    )
+    result = out if _WORKER["binary"] else out.getvalue()
+    return count, result, len(lines)
+
+
+def _detect_delimiter(path) -> str:
+    with open(path, newline="") as stream:
+        for line in stream:
+            if line.strip() and not line.startswith("#"):
+                return "\t" if "\t" in line else ","
+    return ","
+
+
+def process_file_parallel(
+    path,
+    formulas: Sequence[str],
+    inputs: str,
+    kind: str,
+    out: TextIO,
+    jobs: int,
+    chunk_bytes: int = 1 << 22,
+    delimiter: str = "",
+    out_delimiter: str = ",",
+    header: bool = True,
+    style: str = "fraction",
+    digits: int = 6,
+    native: bool = False,
+) -> int:
+    """Evaluate formulas over a CSV/TSV file with several worker processes
+
+    The file is split into byte ranges aligned on line boundaries. Each worker reads its
+    ranges directly from the file and returns the formatted output text, so no per-row
+    objects are pickled, except for binary output. At most ``2 * jobs`` ranges are in
+    flight, and results are written in input order.
+
+    Args:
+      path: the input file
+      formulas (Sequence[str]): names from :data:`FORMULAS`
+      inputs (str): ``"quadrances"`` or ``"coords"``
+      kind (str): the numeric type, a key of :data:`TYPES`
+      out: the output text stream or :obj:`rat_trig.ratfile.RatWriter`
+      jobs (int): the number of worker processes
+      chunk_bytes (int): the target size of a byte range
+      delimiter (str): the input field separator, detected from the first line by default
+      out_delimiter (str): the output field separator
+      header (bool): whether to write a header row of formula names
+      style (str): the text format, a key of :data:`rat_trig.fmt.STYLES`
+      digits (int): the number of digits after the point for the decimal and scientific
+          styles
+      native (bool): try the C tokenizer of :mod:`rat_trig.parse` first
+
+    Returns:
+      int: the number of rows processed
+    """
+    binary = hasattr(out, "write_chunk")
+    if header:
+        _write_header(out, dict.fromkeys(formulas), out_delimiter)
+    delimiter = delimiter or _detect_delimiter(path)
+    count = lines = 0
+    pending: Deque[Future] = collections.deque()
+
+    def write_next() -> None:
+        nonlocal count, lines
+        try:
+            rows, result, newlines = pending.popleft().result()
+        except ParseError as err:
+            line = None if err.line is None else lines + err.line
+            raise ParseError(err.reason, line, err.field) from None
+        if binary:
+            for chunk in result:
+                out.write_chunk(chunk)
+        else:
+            out.write(result)
+        count += rows
+        lines += newlines
+        _logger.debug("processed %d rows", count)
+
+    initargs = (formulas, inputs, kind, delimiter, out_delimiter, style, digits)
+    initargs += (binary, native)
+    with ProcessPoolExecutor(jobs, initializer=_init_worker, initargs=initargs) as pool:
+        try:
+            for start, end in byte_ranges(path, chunk_bytes):
+                if len(pending) >= 2 * jobs:
+                    write_next()
+                pending.append(pool.submit(_process_range, path, start, end))
+            while pending:
+                write_next()
+        finally:
+            for future in pending:
+                future.cancel()
+    return count
+
+
+def process_file_resumable(
+    path,
+    program: Program,
+    kind: str,
+    out_path,
+    checkpoint_path,
+    names: Sequence[str] = INPUT_COLUMNS["quadrances"],
+    chunk_size: int = 65536,
+    delimiter: str = "",
+    out_delimiter: str = ",",
+    header: bool = True,
+    style: str = "fraction",
+    digits: int = 6,
+    interval: float = 10.0,
+    native: bool = False,
+) -> int:
+    """Evaluate a program over a CSV/TSV file into an output file, with checkpoints
+
+    After a chunk has been written, and at most once per ``interval`` seconds, the output
+    is flushed to disk and a :mod:`rat_trig.checkpoint` is saved. If the checkpoint file
+    exists when the run starts, the output is truncated to the checkpointed length and the
+    run resumes from the checkpointed input offset, so an interrupted run produces the same
+    output as an uninterrupted one. The checkpoint is removed when the run completes.
+
+    Args:
+      path: the input file
+      program (:obj:`rat_trig.expr.Program`): the compiled formulas
+      kind (str): the numeric type, a key of :data:`TYPES`
+      out_path: the output file
+      checkpoint_path: the checkpoint file
+      names (Sequence[str]): the variable names of the input fields, in row order
+      chunk_size (int): the number of lines evaluated at once
+      delimiter (str): the input field separator, detected from the first line by default
+      out_delimiter (str): the output field separator
+      header (bool): whether to write a header row of formula names
+      style (str): the text format, a key of :data:`rat_trig.fmt.STYLES`
+      digits (int): the number of digits after the point for the decimal and scientific
+          styles
+      interval (float): the least number of seconds between checkpoints
+      native (bool): try the C tokenizer of :mod:`rat_trig.parse` first
+
+    Returns:
+      int: the number of rows processed, including those of earlier runs
+
+    Raises:
+      :obj:`rat_trig.checkpoint.CheckpointError`: if the checkpoint belongs to another
+          input file or other settings
+    """
+    delimiter = delimiter or _detect_delimiter(path)
+    settings = [list(program.outputs), kind, list(names), delimiter]
+    settings += [out_delimiter, header, style, digits, chunk_size]
+    key = fingerprint(path, *settings)
+    state = load_checkpoint(checkpoint_path)
+    if state is not None and state.fingerprint != key:
+        raise CheckpointError(
+            f"{checkpoint_path} belongs to another input file or other settings"
+        )
+    with open(path, "rb") as src, open(
+        out_path, "wb" if state is None else "r+b"
+    ) as dst:
+        if state is None:
+            state = Checkpoint(key)
+            if header:
+                dst.write((out_delimiter.join(program.outputs) + "\n").encode())
+        else:
+            _logger.info("resuming %s after %d rows", path, state.rows)
+            dst.truncate(state.output_offset)
+            dst.seek(state.output_offset)
+            src.seek(state.input_offset)
+        saved = time.monotonic()
+        while True:
+            raw = list(itertools.islice(src, chunk_size))
+            if not raw:
+                break
+            text = io.StringIO()
+            rows = process_stream(
+                [line.decode() for line in raw],
+                program,
+                kind,
+                text,
+                names,
+                chunk_size,
+                delimiter,
+                out_delimiter,
+                header=False,
+                first_line=state.lines + 1,
+                style=style,
+                digits=digits,
+                native=native,
+            )
+            dst.write(text.getvalue().encode())
+            state = state._replace(
+                input_offset=state.input_offset + sum(map(len, raw)),
+                lines=state.lines + len(raw),
+                rows=state.rows + rows,
+                output_offset=dst.tell(),
+            )
+            if time.monotonic() - saved >= interval:
+                dst.flush()
+                os.fsync(dst.fileno())
+                save_checkpoint(checkpoint_path, state)
+                saved = time.monotonic()
+                _logger.debug("checkpoint after %d rows", state.rows)
+    remove_checkpoint(checkpoint_path)
+    return state.rows
 
 
 # ---- CLI ----
@@ -72,13 +586,117 @@ def parse_args(args):
     Returns:
       :obj:`argparse.Namespace`: command line parameters namespace
     """
-    parser = argparse.ArgumentParser(description="Just a Fibonacci demonstration")
+    parser = argparse.ArgumentParser(
+        description="Evaluate rational trigonometry formulas over CSV/TSV triangles"
+    )
     parser.add_argument(
         "--version",
         action="version",
         version=f"rat-trig {__version__}",
     )
-    parser.add_argument(dest="n", help="n-th Fibonacci number", type=int, metavar="INT")
+    parser.add_argument(
+        dest="files",
+        nargs="*",
+        default=["-"],
+        metavar="FILE",
+        help="input CSV/TSV or .rat files, '-' for stdin (default)",
+    )
+    parser.add_argument(
+        "-i",
+        "--input",
+        choices=sorted(INPUT_COLUMNS),
+        default="quadrances",
+        help="what the input rows contain: q_1,q_2,q_3 or x_1,y_1,x_2,y_2,x_3,y_3",
+    )
+    parser.add_argument(
+        "-f",
+        "--formula",
+        dest="formulas",
+        action="append",
+        choices=FORMULAS,
+        help="formula to evaluate, may be repeated (default: quadrea)",
+    )
+    parser.add_argument(
+        "-t",
+        "--type",
+        choices=sorted(TYPES),
+        default="fraction",
+        help="numeric type of the input values (default: fraction)",
+    )
+    parser.add_argument(
+        "-d",
+        "--delimiter",
+        default="",
+        help="input field separator (default: tab if present, else comma)",
+    )
+    parser.add_argument(
+        "-o",
+        "--output",
+        default="-",
+        help="output file, '-' for stdout (default); a .rat file is written in binary",
+    )
+    parser.add_argument(
+        "--format",
+        dest="style",
+        choices=STYLES,
+        default="fraction",
+        help="text format of the results: p/q, fixed-point or scientific (default: fraction)",
+    )
+    parser.add_argument(
+        "--digits",
+        type=int,
+        default=6,
+        help="digits after the point for --format decimal or scientific (default: 6)",
+    )
+    parser.add_argument(
+        "--native-parse",
+        dest="native",
+        action="store_true",
+        help="tokenize CSV/TSV input in C when a C compiler is available",
+    )
+    parser.add_argument(
+        "--chunk-size",
+        type=int,
+        default=65536,
+        help="number of rows evaluated at once (default: 65536)",
+    )
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=1,
+        help="number of worker processes for CSV/TSV files (default: 1)",
+    )
+    parser.add_argument(
+        "--chunk-bytes",
+        type=int,
+        default=1 << 22,
+        help="size of the byte ranges handed to workers with --jobs (default: 4 MiB)",
+    )
+    parser.add_argument(
+        "--checkpoint",
+        metavar="FILE",
+        help="save progress to FILE and resume from it when it exists; "
+        "needs one input file and -o FILE",
+    )
+    parser.add_argument(
+        "--checkpoint-interval",
+        type=float,
+        default=10.0,
+        metavar="SECONDS",
+        help="least time between checkpoints (default: 10)",
+    )
+    parser.add_argument(
+        "--no-header",
+        dest="header",
+        action="store_false",
+        help="do not write a header row",
+    )
+    parser.add_argument(
+        "--stats",
+        action="store_true",
+        help="report the number of rows and the throughput on stderr",
+    )
     parser.add_argument(
         "-v",
         "--verbose",
@@ -95,36 +713,238 @@ def parse_args(args):
         action="store_const",
         const=logging.DEBUG,
     )
-    return parser.parse_args(args)
+    parsed = parser.parse_args(args)
+    if parsed.chunk_size < 1:
+        parser.error("--chunk-size must be positive")
+    if parsed.jobs < 1 or parsed.chunk_bytes < 1:
+        parser.error("--jobs and --chunk-bytes must be positive")
+    if parsed.jobs > 1 and "-" in parsed.files:
+        parser.error("--jobs needs input files; it cannot split stdin")
+    if parsed.digits < 0:
+        parser.error("--digits must not be negative")
+    if parsed.checkpoint and (
+        len(parsed.files) != 1
+        or parsed.files[0] == "-"
+        or parsed.output in ("-", "")
+        or parsed.output.endswith(".rat")
+        or parsed.jobs > 1
+    ):
+        parser.error(
+            "--checkpoint needs one input file, a text output file and no --jobs"
+        )
+    parsed.formulas = parsed.formulas or ["quadrea"]
+    return parsed
+
+
+def parse_serve_args(args):
+    """Parse the command line parameters of ``rat-trig serve``
+
+    Args:
+      args (List[str]): command line parameters after ``serve``
+
+    Returns:
+      :obj:`argparse.Namespace`: command line parameters namespace
+    """
+    parser = argparse.ArgumentParser(
+        prog="rat-trig serve",
+        description="Answer quadrea requests, coalescing concurrent ones into batches",
+    )
+    where = parser.add_mutually_exclusive_group()
+    where.add_argument("--unix", metavar="PATH", help="listen on a Unix domain socket")
+    where.add_argument(
+        "--port", type=int, default=7461, help="listen on a TCP port (default: 7461)"
+    )
+    parser.add_argument(
+        "--host", default="127.0.0.1", help="TCP address (default: 127.0.0.1)"
+    )
+    parser.add_argument(
+        "--deadline-us",
+        type=float,
+        default=200.0,
+        help="longest wait for a batch to fill, in microseconds (default: 200)",
+    )
+    parser.add_argument(
+        "--max-batch",
+        type=int,
+        default=65536,
+        help="number of triangles that closes a batch early (default: 65536)",
+    )
+    parser.add_argument(
+        "-v",
+        "--verbose",
+        dest="loglevel",
+        help="set loglevel to INFO",
+        action="store_const",
+        const=logging.INFO,
+    )
+    parsed = parser.parse_args(args)
+    if parsed.deadline_us < 0 or parsed.max_batch < 1:
+        parser.error("--deadline-us must not be negative, --max-batch must be positive")
+    return parsed
+
+
+async def _serve(args) -> None:
+    server = await BatchServer.start(
+        args.unix, args.host, args.port, args.deadline_us * 1e-6, args.max_batch
+    )
+    _logger.info("listening on %s", server.address)
+    try:
+        await server.serve_forever()
+    finally:
+        _logger.info("metrics: %s", server.metrics.snapshot(server.queue_depth))
+        await server.close()
+
+
+def serve_main(args):
+    """Run ``rat-trig serve`` until interrupted
+
+    Args:
+      args (List[str]): command line parameters after ``serve``
+
+    Returns:
+      int: the exit status
+    """
+    args = parse_serve_args(args)
+    setup_logging(args.loglevel)
+    try:
+        asyncio.run(_serve(args))
+    except KeyboardInterrupt:
+        pass
+    except OSError as err:
+        _logger.error("%s: %s", args.unix or f"{args.host}:{args.port}", err)
+        return 1
+    return 0
 
 
 def setup_logging(loglevel):
     """Setup basic logging
 
+    Log messages go to ``stderr``, since ``stdout`` carries the results.
+
     Args:
       loglevel (int): minimum loglevel for emitting messages
     """
     logformat = "[%(asctime)s] %(levelname)s:%(name)s:%(message)s"
     logging.basicConfig(
-        level=loglevel, stream=sys.stdout, format=logformat, datefmt="%Y-%m-%d %H:%M:%S"
+        level=loglevel, stream=sys.stderr, format=logformat, datefmt="%Y-%m-%d %H:%M:%S"
     )
 
 
-def main(args):
-    """Wrapper allowing :func:`fib` to be called with string arguments in a CLI fashion
+def _open_input(path: str) -> ContextManager[TextIO]:
+    return contextlib.nullcontext(sys.stdin) if path == "-" else open(path, newline="")
 
-    Instead of returning the value from :func:`fib`, it prints the result to the
-    ``stdout`` in a nicely formatted message.
+
+def main(args):
+    """Wrapper allowing :func:`process_stream` to be called with string arguments in a
+    CLI fashion
 
     Args:
       args (List[str]): command line parameters as list of strings
-          (for example  ``["--verbose", "42"]``).
+          (for example  ``["--verbose", "-f", "quadrea", "triangles.csv"]``).
+
+    Returns:
+      int: the exit status
     """
+    if args[:1] == ["serve"]:
+        return serve_main(args[1:])
     args = parse_args(args)
     setup_logging(args.loglevel)
-    _logger.debug("Starting crazy calculations...")
-    print(f"The {args.n}-th Fibonacci number is {fib(args.n)}")
-    _logger.info("Script ends here")
+    program = build_program(args.formulas, args.input)
+    if args.type == "int" and has_division(program):
+        _logger.error("formulas with division need --type fraction or float")
+        return 2
+    if args.checkpoint:
+        out = None  # the resumable runner manages the output file
+    elif args.output.endswith(".rat"):
+        if args.type == "float":
+            _logger.error("binary .rat output needs --type int or fraction")
+            return 2
+        out = RatWriter(args.output, program.outputs)
+    elif args.output == "-":
+        out = sys.stdout
+    else:
+        out = open(args.output, "w", newline="")
+    delimiter = args.delimiter or ","
+    start = time.perf_counter()
+    total = 0
+    try:
+        for k, path in enumerate(args.files):
+            _logger.info("reading %s", path)
+            if args.checkpoint:
+                total += process_file_resumable(
+                    path,
+                    program,
+                    args.type,
+                    args.output,
+                    args.checkpoint,
+                    INPUT_COLUMNS[args.input],
+                    args.chunk_size,
+                    args.delimiter,
+                    delimiter,
+                    args.header,
+                    args.style,
+                    args.digits,
+                    args.checkpoint_interval,
+                    args.native,
+                )
+                continue
+            if path.endswith(".rat"):
+                total += process_ratfile(
+                    path,
+                    program,
+                    args.type,
+                    out,
+                    delimiter,
+                    args.header and k == 0,
+                    args.style,
+                    args.digits,
+                )
+                continue
+            if args.jobs > 1:
+                total += process_file_parallel(
+                    path,
+                    args.formulas,
+                    args.input,
+                    args.type,
+                    out,
+                    args.jobs,
+                    args.chunk_bytes,
+                    args.delimiter,
+                    delimiter,
+                    args.header and k == 0,
+                    args.style,
+                    args.digits,
+                    args.native,
+                )
+                continue
+            with _open_input(path) as stream:
+                total += process_stream(
+                    stream,
+                    program,
+                    args.type,
+                    out,
+                    INPUT_COLUMNS[args.input],
+                    args.chunk_size,
+                    args.delimiter,
+                    delimiter,
+                    args.header and k == 0,
+                    style=args.style,
+                    digits=args.digits,
+                    native=args.native,
+                )
+    except (OSError, ValueError) as err:
+        _logger.error("%s: %s", path, err)
+        return 1
+    finally:
+        if out is not None and out is not sys.stdout:
+            out.close()
+    elapsed = time.perf_counter() - start
+    rate = total / elapsed if elapsed > 0 else float("inf")
+    message = f"{total} rows in {elapsed:.3f} s ({rate:,.0f} rows/s)"
+    _logger.info(message)
+    if args.stats:
+        print(message, file=sys.stderr)
+    return 0
 
 
 def run():
@@ -132,7 +952,7 @@ def run():
 
     This function can be used as entry point to create console scripts with setuptools.
     """
-    main(sys.argv[1:])
+    sys.exit(main(sys.argv[1:]))
 
 
 if __name__ == "__main__":
@@ -144,6 +964,6 @@ if __name__ == "__main__":
     # After installing your project with pip, users can also run your Python
     # modules as scripts via the ``-m`` flag, as defined in PEP 338::
     #
-    #     python -m rat_trig.skeleton 42
+    #     python -m rat_trig.skeleton triangles.csv
     #
     run()
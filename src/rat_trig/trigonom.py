@@ -23,10 +23,35 @@ rational numbers and operations, rather than irrational numbers and limits, maki
 straightforward and intuitive subject to understand and work with.
 """
 
-from typing import TypeVar
+from typing import Iterable, List, Sequence, TypeVar
 from fractions import Fraction
 
-T = TypeVar("T", int, Fraction, float)
+from . import instrument
+from .interval import Interval
+from .lazy import LazyFraction
+
+T = TypeVar("T", int, Fraction, float, LazyFraction, Interval)
+
+
+def quadrance(p_1: Sequence[T], p_2: Sequence[T]) -> T:
+    r"""
+    The function `quadrance` calculates the quadrance, i.e. the squared distance, between two
+    points `p_1` and `p_2` given by their coordinates. Only ring operations are used, so the
+    result is exact for `int` and `Fraction` coordinates.
+
+    :param p_1: The coordinates of the first point
+    :type p_1: Sequence[T]
+    :param p_2: The coordinates of the second point, of the same dimension as `p_1`
+    :type p_2: Sequence[T]
+    :return: the sum of \((p_1[i] - p_2[i])^2\) over all coordinates.
+
+    Example:
+        >>> quadrance((0, 0), (3, 4))
+        25
+        >>> quadrance((Fraction(1, 2), 0, 1), (0, Fraction(1, 3), 1))
+        Fraction(13, 36)
+    """
+    return sum((a - b) * (a - b) for a, b in zip(p_1, p_2))
 
 
 def archimedes(q_1: T, q_2: T, q_3: T) -> T:
@@ -54,11 +79,44 @@ def archimedes(q_1: T, q_2: T, q_3: T) -> T:
         >>> q_3 = Fraction(1, 6)
         >>> archimedes(q_1, q_2, q_3)
         Fraction(23, 144)
+        >>> archimedes(LazyFraction(1, 2), LazyFraction(1, 4), LazyFraction(1, 6))
+        LazyFraction(23, 144)
     """
     temp = q_1 + q_2 - q_3
     return 4 * q_1 * q_2 - temp * temp
 
 
+def archimedes_batch(
+    q_1s: Iterable[T], q_2s: Iterable[T], q_3s: Iterable[T]
+) -> List[T]:
+    r"""
+    The function `archimedes_batch` evaluates `archimedes` element-wise over three columns of
+    quadrances. The formula is inlined in a single comprehension, which avoids a Python-level
+    function call per triangle.
+
+    :param q_1s: The first quadrances
+    :type q_1s: Iterable[T]
+    :param q_2s: The second quadrances
+    :type q_2s: Iterable[T]
+    :param q_3s: The third quadrances
+    :type q_3s: Iterable[T]
+    :return: the list of quadreas, stopping at the end of the shortest column
+
+    Example:
+        >>> archimedes_batch([2, 1], [4, 1], [6, 1])
+        [32, 3]
+    """
+    return [
+        4 * q_1 * q_2 - (temp := q_1 + q_2 - q_3) * temp
+        for q_1, q_2, q_3 in zip(q_1s, q_2s, q_3s)
+    ]
+
+
+if instrument.ENABLED:  # opt-in bit-growth instrumentation, see rat_trig.instrument
+    instrument.instrument_namespace(
+        globals(), ("quadrance", "archimedes", "archimedes_batch"), "trigonom"
+    )
+
 if __name__ == "__main__":
     import doctest
 
@@ -0,0 +1,222 @@
+"""
+Vectors of any fixed dimension, with exact dot products, quadrances and spreads.
+
+`Vector` is an immutable tuple-backed vector generic over the coordinate type. The spread
+between two vectors is `1 - (u . v)^2 / (Q(u) Q(v))`, which only needs ring operations and one
+division, so it is exact for `int` and `Fraction` coordinates in any dimension.
+
+`VectorArray` stores many vectors of the same dimension in one flat contiguous column: an
+`array("q")` for int64 coordinates, an `array("d")` for floats, or a list for exact rationals.
+Its batch operations multiply whole columns with `map(operator.mul, ...)` and sum each row with
+`map(sum, ...)`, so no Python-level loop runs per coordinate. Sums of int64 products are
+accumulated in Python integers, which cannot overflow, so the results are exact where a native
+kernel would need 128-bit accumulators.
+"""
+
+import operator
+from array import array
+from fractions import Fraction
+from typing import Generic, Iterable, Iterator, List, Sequence, TypeVar, Union
+
+T = TypeVar("T", int, Fraction, float)
+
+_mul = operator.mul
+_sub = operator.sub
+
+
+class Vector(Generic[T]):
+    """
+    An immutable vector of fixed dimension.
+
+    Example:
+        >>> u, v = Vector((1, 0, 1)), Vector((0, 1, 1))
+        >>> u.dot(v), u.quadrance(), u.spread(v)
+        (1, 2, Fraction(3, 4))
+        >>> u - v
+        Vector((1, -1, 0))
+    """
+
+    __slots__ = ("_coords",)
+
+    def __init__(self, coords: Iterable[T]) -> None:
+        """
+        :param coords: The coordinates
+        :type coords: Iterable[T]
+        """
+        self._coords = tuple(coords)
+
+    def __repr__(self) -> str:
+        return f"Vector({self._coords!r})"
+
+    def __len__(self) -> int:
+        return len(self._coords)
+
+    def __iter__(self) -> Iterator[T]:
+        return iter(self._coords)
+
+    def __getitem__(self, index: int) -> T:
+        return self._coords[index]
+
+    def __eq__(self, other) -> bool:
+        if not isinstance(other, Vector):
+            return NotImplemented
+        return self._coords == other._coords
+
+    def __hash__(self) -> int:
+        return hash(self._coords)
+
+    def _check(self, other: "Vector[T]") -> None:
+        if len(other._coords) != len(self._coords):
+            raise ValueError(
+                f"dimension mismatch: {len(self._coords)} and {len(other._coords)}"
+            )
+
+    def __add__(self, other: "Vector[T]") -> "Vector[T]":
+        self._check(other)
+        return Vector(map(operator.add, self._coords, other._coords))
+
+    def __sub__(self, other: "Vector[T]") -> "Vector[T]":
+        self._check(other)
+        return Vector(map(_sub, self._coords, other._coords))
+
+    def __neg__(self) -> "Vector[T]":
+        return Vector(map(operator.neg, self._coords))
+
+    def __mul__(self, scalar: T) -> "Vector[T]":
+        return Vector(c * scalar for c in self._coords)
+
+    __rmul__ = __mul__
+
+    def dot(self, other: "Vector[T]") -> T:
+        """The dot product"""
+        self._check(other)
+        return sum(map(_mul, self._coords, other._coords))
+
+    def quadrance(self) -> T:
+        """The quadrance from the origin, i.e. the squared length"""
+        return sum(map(_mul, self._coords, self._coords))
+
+    def quadrance_to(self, other: "Vector[T]") -> T:
+        """The quadrance between the points `self` and `other`"""
+        diff = (self - other)._coords
+        return sum(map(_mul, diff, diff))
+
+    def spread(self, other: "Vector[T]") -> Union[T, Fraction]:
+        """
+        The spread between the directions of two nonzero vectors.
+
+        :raises ZeroDivisionError: if either vector is zero
+        """
+        dot = self.dot(other)
+        den = self.quadrance() * other.quadrance()
+        if isinstance(den, int):
+            return 1 - Fraction(dot * dot, den)
+        return 1 - dot * dot / den
+
+
+def _column(values: Iterable, typecode: str) -> Union[array, list]:
+    return array(typecode, values) if typecode else list(values)
+
+
+class VectorArray:
+    """
+    Many vectors of the same dimension in one flat column.
+
+    Example:
+        >>> vs = VectorArray.from_vectors([(1, 2, 2), (0, 3, 4)], typecode="q")
+        >>> vs.quadrances()
+        [9, 25]
+        >>> vs.dots(vs.roll(1)), vs.quadrances_to(vs.roll(1))
+        ([14, 14], [6, 6])
+    """
+
+    def __init__(self, data: Union[array, List], dim: int) -> None:
+        """
+        :param data: The coordinates of all vectors, row after row
+        :type data: Union[array, List]
+        :param dim: The dimension of each vector
+        :type dim: int
+        """
+        if dim < 1 or len(data) % dim:
+            raise ValueError(f"{len(data)} coordinates do not split into rows of {dim}")
+        self.data = data
+        self.dim = dim
+
+    @classmethod
+    def from_vectors(
+        cls, vectors: Iterable[Sequence[T]], dim: int = 0, typecode: str = ""
+    ) -> "VectorArray":
+        """
+        Build from a sequence of vectors.
+
+        :param vectors: The vectors
+        :param dim: The dimension, by default that of the first vector
+        :param typecode: `"q"` for int64 or `"d"` for float64 storage in an `array`; by default
+            the coordinates are kept as Python objects in a list
+        """
+        vectors = [tuple(v) for v in vectors]
+        if not dim:
+            if not vectors:
+                raise ValueError("the dimension of an empty array must be given")
+            dim = len(vectors[0])
+        if any(len(v) != dim for v in vectors):
+            raise ValueError(f"all vectors must have dimension {dim}")
+        return cls(_column((c for v in vectors for c in v), typecode), dim)
+
+    @property
+    def typecode(self) -> str:
+        return self.data.typecode if isinstance(self.data, array) else ""
+
+    def __len__(self) -> int:
+        return len(self.data) // self.dim
+
+    def __getitem__(self, index: int) -> Vector:
+        if index < 0:
+            index += len(self)
+        if not 0 <= index < len(self):
+            raise IndexError("vector index out of range")
+        return Vector(self.data[index * self.dim : (index + 1) * self.dim])
+
+    def __iter__(self) -> Iterator[Vector]:
+        return (self[i] for i in range(len(self)))
+
+    def roll(self, shift: int) -> "VectorArray":
+        """The vectors rotated by `shift` rows, as `numpy.roll`"""
+        if not len(self):
+            return self
+        cut = (-shift % len(self)) * self.dim
+        return VectorArray(self.data[cut:] + self.data[:cut], self.dim)
+
+    def _check(self, other: "VectorArray") -> None:
+        if other.dim != self.dim or len(other.data) != len(self.data):
+            raise ValueError("arrays differ in dimension or length")
+
+    def _row_sums(self, products: Iterable) -> List:
+        # zip over `dim` references of one iterator yields the rows, summed at C level
+        return list(map(sum, zip(*[iter(products)] * self.dim)))
+
+    def dots(self, other: "VectorArray") -> List:
+        """The dot products of corresponding vectors"""
+        self._check(other)
+        return self._row_sums(map(_mul, self.data, other.data))
+
+    def quadrances(self) -> List:
+        """The quadrances of all vectors from the origin"""
+        return self._row_sums(map(_mul, self.data, self.data))
+
+    def quadrances_to(self, other: "VectorArray") -> List:
+        """The quadrances between corresponding points"""
+        self._check(other)
+        diff = list(map(_sub, self.data, other.data))
+        return self._row_sums(map(_mul, diff, diff))
+
+    def spreads(self, other: "VectorArray") -> List:
+        """The spreads between corresponding nonzero vectors"""
+        dots = self.dots(other)
+        dens = map(_mul, self.quadrances(), other.quadrances())
+        if self.typecode == "d" or other.typecode == "d":
+            return [1.0 - d * d / q for d, q in zip(dots, dens)]
+        return [
+            1 - (Fraction(d * d, q) if isinstance(q, int) else d * d / q)
+            for d, q in zip(dots, dens)
+        ]
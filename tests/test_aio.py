@@ -0,0 +1,163 @@
+import asyncio
+import random
+import threading
+from concurrent.futures import ProcessPoolExecutor, ThreadPoolExecutor
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.aio import archimedes_stream, map_chunks, program_stream
+from rat_trig.expr import compile_exprs, var
+from rat_trig.trigonom import archimedes
+
+
+def _chunks(n, size, seed=45):
+    rng = random.Random(seed)
+    return [
+        [[Fraction(rng.randint(0, 9), rng.randint(1, 9)) for _ in range(size)]] * 3
+        for _ in range(n)
+    ]
+
+
+async def _source(chunks, log=None):
+    try:
+        for chunk in chunks:
+            if log is not None:
+                log.append("pulled")
+            yield chunk
+    finally:
+        if log is not None:
+            log.append("closed")
+
+
+def test_order():
+    """Test that results arrive in input order from a thread pool"""
+    chunks = _chunks(20, 50)
+
+    async def main():
+        with ThreadPoolExecutor(4) as pool:
+            return [r async for r in archimedes_stream(_source(chunks), pool, 3)]
+
+    expected = [[archimedes(*q) for q in zip(*chunk)] for chunk in chunks]
+    assert asyncio.run(main()) == expected
+
+
+def test_process_pool():
+    """Test archimedes_stream on a process pool"""
+    chunks = [([1, 2], [1, 4], [4, 6]), ([3], [3], [3])]
+
+    async def main():
+        with ProcessPoolExecutor(2) as pool:
+            return [r async for r in archimedes_stream(_source(chunks), pool)]
+
+    assert asyncio.run(main()) == [[0, 32], [27]]
+
+
+def test_program_stream():
+    """Test program_stream on the event loop's default executor"""
+    q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+    program = compile_exprs({"s_3": (q_1 + q_2 - q_3) ** 2})
+
+    async def main():
+        chunks = _source([{"q_1": [1, 2], "q_2": [1, 4], "q_3": [4, 6]}])
+        return [r async for r in program_stream(program, chunks)]
+
+    assert asyncio.run(main()) == [{"s_3": [4, 0]}]
+
+
+def test_program_stream_process_pool():
+    """Test that a program evaluates on a process pool like in process"""
+    q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+    program = compile_exprs({"s_3": (q_1 + q_2 - q_3) ** 2, "half": q_1 / 2})
+    chunks = [
+        {"q_1": [Fraction(1, 2), 2], "q_2": [1, 4], "q_3": [4, 6]},
+        {"q_1": [3], "q_2": [3], "q_3": [3]},
+    ]
+
+    async def main():
+        with ProcessPoolExecutor(2) as pool:
+            return [r async for r in program_stream(program, _source(chunks), pool)]
+
+    assert asyncio.run(main()) == [program(**c) for c in chunks]
+
+
+def test_bounded_in_flight():
+    """Test that a slow consumer keeps the source at most max_in_flight chunks ahead"""
+    log = []
+    in_flight = []
+
+    def work(xs):
+        in_flight.append(log.count("pulled") - results)
+        return sum(xs)
+
+    async def main():
+        nonlocal results
+        async for _ in map_chunks(
+            work, _source([[[k]] for k in range(30)], log), None, 4
+        ):
+            results += 1
+            # a slow consumer must not let the source run ahead
+            assert log.count("pulled") - results <= 4
+            await asyncio.sleep(0)
+
+    results = 0
+    asyncio.run(main())
+    assert results == 30 and max(in_flight) <= 4
+    assert log[-1] == "closed"
+
+
+def test_invalid_bound():
+    """Test that a bound below one is rejected"""
+
+    async def main():
+        return [r async for r in map_chunks(sum, _source([]), None, 0)]
+
+    with pytest.raises(ValueError):
+        asyncio.run(main())
+
+
+def test_cancellation():
+    """Test that cancelling the consumer cancels queued chunks and closes the source"""
+    log = []
+    release = threading.Event()
+    started = []
+
+    def work(x):
+        started.append(x)
+        release.wait(5)
+        return x
+
+    async def consume(stream):
+        async for _ in stream:
+            pass
+
+    async def main():
+        with ThreadPoolExecutor(1) as pool:
+            stream = map_chunks(work, _source([[k] for k in range(10)], log), pool, 3)
+            task = asyncio.ensure_future(consume(stream))
+            while not started:
+                await asyncio.sleep(0.001)
+            task.cancel()
+            with pytest.raises(asyncio.CancelledError):
+                await task
+            release.set()
+
+    asyncio.run(main())
+    # only the running chunk was evaluated; the queued ones were cancelled
+    assert started == [0]
+    assert log.count("pulled") == 3 and log[-1] == "closed"
+
+
+def test_early_exit():
+    """Test that closing the stream early closes the source"""
+    log = []
+
+    async def main():
+        stream = map_chunks(sum, _source([[[k]] for k in range(10)], log), None, 2)
+        async for result in stream:
+            break
+        await stream.aclose()
+        return result
+
+    assert asyncio.run(main()) == 0
+    assert log.count("pulled") == 2 and log[-1] == "closed"
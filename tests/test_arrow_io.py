@@ -0,0 +1,101 @@
+import random
+from fractions import Fraction
+
+import pytest
+
+pa = pytest.importorskip("pyarrow")
+
+from rat_trig.arrow_io import (  # noqa: E402
+    RationalType,
+    archimedes_parquet,
+    column_view,
+    from_values,
+    iter_batches,
+    to_values,
+    write_parquet,
+)
+from rat_trig.trigonom import archimedes  # noqa: E402
+
+
+def test_column_view():
+    """Test zero-copy views of int64 and float64 arrays"""
+    column = pa.array(list(range(10)), pa.int64()).slice(3, 4)
+    view = column_view(column)
+    assert view.format == "q" and view.tolist() == [3, 4, 5, 6]
+    assert column_view(pa.chunked_array([[1.5, 2.5]])).tolist() == [1.5, 2.5]
+    with pytest.raises(ValueError):
+        column_view(pa.array([1, None], pa.int64()))
+    with pytest.raises(TypeError):
+        column_view(pa.array([1], pa.int32()))
+
+
+@pytest.mark.parametrize(
+    "values",
+    [
+        [1, -2, 3],
+        [2**70, -(2**100), 0],
+        [1.5, -0.25],
+        [Fraction(1, 3), Fraction(-7, 2), 5],
+        [Fraction(2**80, 3), Fraction(1, 2)],
+    ],
+)
+def test_round_trip(values):
+    """Test that values survive Arrow arrays and IPC files"""
+    column = from_values(values)
+    assert list(to_values(column)) == values
+    # the extension type survives serialization
+    table = pa.table({"v": column})
+    sink = pa.BufferOutputStream()
+    with pa.ipc.new_file(sink, table.schema) as writer:
+        writer.write_table(table)
+    read = pa.ipc.open_file(sink.getvalue()).read_all()
+    assert list(to_values(read.column("v"))) == values
+
+
+def test_too_large():
+    """Test that integers beyond decimal256 are rejected"""
+    with pytest.raises(OverflowError):
+        from_values([10**80])
+
+
+def test_archimedes_parquet(tmp_path):
+    """Test streaming quadreas between Parquet files"""
+    pq = pytest.importorskip("pyarrow.parquet")
+    rng = random.Random(40)
+    n = 1000
+    qs = [[Fraction(rng.randint(0, 99), rng.randint(1, 9)) for _ in range(n)]]
+    qs += [[rng.randint(0, 99) for _ in range(n)] for _ in range(2)]
+    table = pa.table({"q_1": from_values(qs[0]), "q_2": qs[1], "q_3": qs[2]})
+    assert isinstance(table.schema.field("q_1").type, RationalType)
+    src, dst = tmp_path / "in.parquet", tmp_path / "out.parquet"
+    pq.write_table(table, src, row_group_size=300)
+    assert pq.ParquetFile(src).metadata.num_row_groups == 4
+    assert sum(b.num_rows for b in iter_batches(src, batch_size=128)) == n
+    assert archimedes_parquet(src, dst, batch_size=256) == n
+    result = pq.read_table(dst).column("quadrea")
+    assert list(to_values(result)) == [archimedes(*q) for q in zip(*qs)]
+
+
+def test_output_schema(tmp_path):
+    """Test that all batches share one output type when a later one overflows int64"""
+    pq = pytest.importorskip("pyarrow.parquet")
+    src, dst = tmp_path / "in.parquet", tmp_path / "out.parquet"
+    for q in ([1, 2**40], [Fraction(1, 2), Fraction(2**40, 3)]):
+        table = pa.table({name: from_values(q) for name in ("q_1", "q_2", "q_3")})
+        pq.write_table(table, src)
+        # the second batch overflows int64
+        assert archimedes_parquet(src, dst, batch_size=1) == 2
+        result = pq.read_table(dst).column("quadrea")
+        assert list(to_values(result)) == [archimedes(v, v, v) for v in q]
+    assert from_values([1], pa.decimal256(76, 0)).type == pa.decimal256(76, 0)
+    with pytest.raises(OverflowError):
+        from_values([2**70], pa.int64())
+
+
+def test_write_parquet_schema_mismatch(tmp_path):
+    """Test that a schema change fails and leaves no file behind"""
+    batches = [pa.record_batch([pa.array([1])], ["v"])]
+    batches.append(pa.record_batch([pa.array([1.5])], ["v"]))
+    with pytest.raises(ValueError):
+        write_parquet(tmp_path / "out.parquet", batches)
+    assert list(tmp_path.iterdir()) == []
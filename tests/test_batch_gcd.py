@@ -0,0 +1,75 @@
+import random
+from fractions import Fraction
+from math import gcd, prod
+
+import pytest
+
+from rat_trig import batch_gcd as batch_gcd_module
+from rat_trig.batch_gcd import (
+    batch_gcd,
+    normalize_batch,
+    product_tree,
+    remainder_tree,
+    shared_factor_mask,
+    to_fractions,
+)
+from rat_trig.trigonom import archimedes
+
+
+def _columns(rng):
+    nums = [
+        archimedes(*(rng.randint(-(2**70), 2**70) for _ in range(3)))
+        for _ in range(200)
+    ]
+    dens = [rng.choice([-1, 1]) * rng.randint(1, 2**90) for _ in range(200)]
+    return nums, dens
+
+
+def test_normalize_batch():
+    """Test the reduced columns and Fraction objects against Fraction"""
+    nums, dens = _columns(random.Random(38))
+    fracs = to_fractions(nums, dens)
+    assert fracs == [Fraction(n, d) for n, d in zip(nums, dens)]
+    for f in fracs:
+        assert f.denominator > 0 and gcd(f.numerator, f.denominator) == 1
+    with pytest.raises(ZeroDivisionError):
+        normalize_batch([1, 2], [3, 0])
+    with pytest.raises(ValueError):
+        normalize_batch([1, 2], [3])
+
+
+def test_fallback_constructor(monkeypatch):
+    """Test the public constructor is used when the private one does not work"""
+
+    def broken(num, den):
+        raise AttributeError("no slots")
+
+    assert batch_gcd_module._select_coprime(broken) is Fraction
+    assert batch_gcd_module._select_coprime(lambda n, d: Fraction(n + 1, d)) is Fraction
+    assert batch_gcd_module._coprime is not Fraction  # CPython
+    monkeypatch.setattr(batch_gcd_module, "_coprime", Fraction)
+    nums, dens = _columns(random.Random(39))
+    assert to_fractions(nums, dens) == [Fraction(n, d) for n, d in zip(nums, dens)]
+
+
+def test_trees():
+    """Test the product and remainder trees"""
+    rng = random.Random(40)
+    values = [rng.randint(2, 2**64) for _ in range(37)]
+    tree = product_tree(values)
+    assert tree[-1] == [prod(values)]
+    x = rng.randint(0, 2**3000)
+    assert remainder_tree(x, tree) == [x % v for v in values]
+    assert remainder_tree(x, tree, square=True) == [x % (v * v) for v in values]
+
+
+def test_batch_gcd():
+    """Test batch gcd against the gcd with the product of the others"""
+    rng = random.Random(41)
+    values = [rng.randint(2, 10**6) for _ in range(50)]
+    expected = [
+        gcd(v, prod(values[:i] + values[i + 1 :])) for i, v in enumerate(values)
+    ]
+    assert batch_gcd(values) == expected
+    assert shared_factor_mask([6, 35, 11, 10]) == [True, True, False, True]
+    assert batch_gcd([7]) == [1]
@@ -0,0 +1,131 @@
+import os
+import random
+import signal
+import subprocess
+import sys
+
+import pytest
+
+from rat_trig.checkpoint import (
+    Checkpoint,
+    CheckpointError,
+    fingerprint,
+    load_checkpoint,
+    remove_checkpoint,
+    save_checkpoint,
+)
+from rat_trig import skeleton
+from rat_trig.skeleton import main
+
+SRC = os.path.join(os.path.dirname(__file__), "..", "src")
+
+
+def test_save_load(tmp_path):
+    """Test atomic saves, loading and removal of checkpoints"""
+    path = tmp_path / "run.ckpt"
+    assert load_checkpoint(path) is None
+    state = Checkpoint("f", 10, 2, 2, 7)
+    save_checkpoint(path, state)
+    save_checkpoint(path, state._replace(rows=3))
+    assert load_checkpoint(path).rows == 3
+    assert os.listdir(tmp_path) == ["run.ckpt"]  # no temporary files left
+    path.write_text("{")
+    with pytest.raises(CheckpointError):
+        load_checkpoint(path)
+    remove_checkpoint(path)
+    remove_checkpoint(path)
+    assert not path.exists()
+
+
+def test_fingerprint(tmp_path):
+    """Test that fingerprints change with the settings and the input file"""
+    path = tmp_path / "in.csv"
+    path.write_text("1,2,3\n")
+    assert fingerprint(path, "a") == fingerprint(path, "a") != fingerprint(path, "b")
+    key = fingerprint(path)
+    path.write_text("1,2,4\n1,1,1\n")
+    assert fingerprint(path) != key
+
+
+def _write_input(path, n):
+    rng = random.Random(n)
+    with open(path, "w") as stream:
+        for _ in range(n):
+            fields = (
+                f"{rng.randint(1, 10**6)}/{rng.randint(1, 999)}" for _ in range(3)
+            )
+            stream.write(",".join(fields) + "\n")
+
+
+def test_resume(tmp_path, monkeypatch):
+    """Test that a run interrupted mid-chunk resumes to the same output"""
+    src, ref = tmp_path / "in.csv", tmp_path / "ref.csv"
+    out, ckpt = tmp_path / "out.csv", tmp_path / "run.ckpt"
+    _write_input(src, 1000)
+    args = ["-f", "quadrea", "-f", "spread_3", "--chunk-size", "100", str(src)]
+    assert main(args + ["-o", str(ref)]) == 0
+    resumable = args + ["-o", str(out), "--checkpoint", str(ckpt)]
+    resumable += ["--checkpoint-interval", "0"]
+    assert main(resumable) == 0
+    assert not ckpt.exists() and out.read_bytes() == ref.read_bytes()
+    # crash in the fourth chunk, after output was written past the checkpoint
+    calls = []
+    process_stream = skeleton.process_stream
+
+    def crashing(*args, **kwargs):
+        calls.append(1)
+        if len(calls) == 4:
+            with open(out, "ab") as stream:
+                stream.write(b"partial garbage")
+            raise KeyboardInterrupt
+        return process_stream(*args, **kwargs)
+
+    monkeypatch.setattr(skeleton, "process_stream", crashing)
+    with pytest.raises(KeyboardInterrupt):
+        main(resumable)
+    monkeypatch.setattr(skeleton, "process_stream", process_stream)
+    assert load_checkpoint(ckpt).rows == 300
+    assert main(resumable) == 0
+    assert out.read_bytes() == ref.read_bytes()
+    # a checkpoint of other settings is refused
+    save_checkpoint(ckpt, Checkpoint("other", 1, 1, 1, 1))
+    assert main(resumable) == 1
+    with pytest.raises(SystemExit):
+        main(args + ["--checkpoint", str(ckpt)])  # no output file
+
+
+# runs the CLI and kills itself with SIGKILL while evaluating the chunk given by argv[1]
+_KILLED_RUN = """
+import os, signal, sys
+from rat_trig import skeleton
+
+process_stream, calls = skeleton.process_stream, []
+
+def killing(*args, **kwargs):
+    calls.append(1)
+    if len(calls) == int(sys.argv[1]):
+        os.kill(os.getpid(), signal.SIGKILL)
+    return process_stream(*args, **kwargs)
+
+skeleton.process_stream = killing
+sys.exit(skeleton.main(sys.argv[2:]))
+"""
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="needs SIGKILL")
+def test_kill_and_resume(tmp_path):
+    """Test that a run killed with SIGKILL resumes to the same output"""
+    src, ref = tmp_path / "in.csv", tmp_path / "ref.csv"
+    out, ckpt = tmp_path / "out.csv", tmp_path / "run.ckpt"
+    _write_input(src, 2000)
+    args = ["-f", "quadrea", "-f", "spread_3", "--chunk-size", "200", str(src)]
+    assert main(args + ["-o", str(ref)]) == 0
+    args += ["-o", str(out), "--checkpoint", str(ckpt), "--checkpoint-interval", "0"]
+    env = dict(os.environ, PYTHONPATH=SRC)
+    killed = subprocess.run([sys.executable, "-c", _KILLED_RUN, "6"] + args, env=env)
+    assert killed.returncode == -signal.SIGKILL
+    assert load_checkpoint(ckpt).rows == 1000
+    command = [sys.executable, "-m", "rat_trig.skeleton"] + args
+    assert subprocess.run(command, env=env).returncode == 0
+    assert not ckpt.exists()
+    assert out.read_bytes() == ref.read_bytes()
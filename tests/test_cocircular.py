@@ -0,0 +1,71 @@
+from itertools import combinations
+from fractions import Fraction
+
+from rat_trig.cocircular import circle_key, cocircular_groups
+
+
+def _grid(n):
+    return [(x, y) for x in range(n) for y in range(n)]
+
+
+def _brute_force(points):
+    """Maximal cocircular sets from all triples, the O(N^4)-style reference"""
+    circles = {}
+    for i, j, k in combinations(range(len(points)), 3):
+        key = circle_key(points[i], points[j], points[k])
+        if key is not None:
+            circles.setdefault(key, set()).update((i, j, k))
+    return sorted(
+        (key, tuple(sorted(members)))
+        for key, members in circles.items()
+        if len(members) >= 4
+    )
+
+
+def test_circle_key():
+    """Test the canonical circle key"""
+    assert circle_key((0, 0), (2, 0), (0, 2)) == (1, 1, 2)
+    assert circle_key((0, 2), (0, 0), (2, 0)) == (1, 1, 2)
+    assert circle_key((0.0, 0.0), (2.0, 0.0), (0.0, 2.0)) == (1, 1, 2)
+    assert circle_key((0, 0), (1, 1), (2, 2)) is None
+    assert circle_key((1, 1), (1, 1), (2, 3)) is None
+
+    half = Fraction(1, 2)
+    assert circle_key((half, 0), (0, half), (-half, 0)) == (0, 0, Fraction(1, 4))
+
+
+def test_cocircular_groups():
+    """Test the grouping against brute force on a lattice"""
+    points = _grid(5)
+    groups = list(cocircular_groups(points))
+    found = sorted(((*g.center, g.quadrance), g.indices) for g in groups)
+    assert found == _brute_force(points)
+    for g in groups:
+        for i in g.indices:
+            assert (points[i][0] - g.center[0]) ** 2 + (
+                points[i][1] - g.center[1]
+            ) ** 2 == g.quadrance
+
+
+def test_cocircular_groups_parallel():
+    """Test the partitioned mode gives the same stream"""
+    points = _grid(4) + [(Fraction(1, 2), Fraction(7, 3))]
+    assert list(cocircular_groups(points, processes=2)) == list(
+        cocircular_groups(points)
+    )
+    assert list(cocircular_groups(points, min_size=5)) == [
+        g for g in cocircular_groups(points) if len(g.indices) >= 5
+    ]
+
+
+def test_cocircular_groups_coincident():
+    """Test that coincident points count once and are all reported"""
+    square = [(1, 0), (0, 1), (-1, 0), (0, -1)]
+    points = square + [(0, 0), (0, 1), (Fraction(2, 2), 0), (0, 1)]
+    groups = list(cocircular_groups(points))
+    assert [g.indices for g in groups] == [(0, 1, 2, 3, 5, 6, 7)]
+    assert groups[0].center == (0, 0) and groups[0].quadrance == 1
+
+    # three distinct points and a copy are not a quadruple
+    assert list(cocircular_groups(square[:3] + [(1, 0)])) == []
+    assert list(cocircular_groups(points, processes=2)) == groups
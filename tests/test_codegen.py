@@ -0,0 +1,74 @@
+import shutil
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.codegen import NativeKernel, compile_native, generate_c
+from rat_trig.expr import Program, var
+from rat_trig.trigonom import archimedes
+
+q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+QUADREA = archimedes(q_1, q_2, q_3)
+
+needs_cc = pytest.mark.skipif(shutil.which("cc") is None, reason="no C compiler")
+
+
+def test_generate_c():
+    """Test the generated source and the rejected formulas"""
+    source = generate_c({"quadrea": QUADREA}, "int64")
+    assert "rt_kernel" in source
+    assert "__builtin_mul_overflow" in source
+    with pytest.raises(ValueError):
+        generate_c({"r": q_1 / q_2}, "int64")
+    with pytest.raises(ValueError):
+        generate_c({"r": q_1 * Fraction(1, 2)}, "int64")
+    with pytest.raises(ValueError):
+        generate_c({"r": q_1}, "int128")
+    with pytest.raises(ValueError):
+        generate_c({"r": q_1 * 10**400})
+
+
+@needs_cc
+def test_special_constants(tmp_path):
+    """Test constants that have no plain C literal"""
+    inf, nan = float("inf"), float("nan")
+    outputs = {"lo": q_1 * 0 - inf, "hi": q_1 + inf, "nan": q_1 + nan}
+    result = NativeKernel(outputs, "double", cache_dir=tmp_path)(q_1=[1.0])
+    assert list(result["lo"]) == [-inf] and list(result["hi"]) == [inf]
+    assert result["nan"][0] != result["nan"][0]
+
+    kernel = NativeKernel({"r": q_1 + -(2**63)}, "int64", cache_dir=tmp_path)
+    assert list(kernel(q_1=[5])["r"]) == [5 - 2**63]
+
+
+@needs_cc
+def test_native_double(tmp_path):
+    """Test a double kernel against the interpreted program and the cache"""
+    outputs = {"quadrea": QUADREA, "spread": QUADREA / (4 * q_1 * q_2), "neg": -q_3}
+    kernel = NativeKernel(outputs, "double", cache_dir=tmp_path)
+    cols = {"q_1": [2.0, 0.5], "q_2": [4.0, 0.25], "q_3": [6.0, 1.0]}
+    assert {k: list(v) for k, v in kernel(**cols).items()} == Program(outputs)(**cols)
+    # a second kernel for the same formula reuses the cached shared object
+    assert NativeKernel(outputs, "double", cache_dir=tmp_path).path == kernel.path
+    assert len(list(tmp_path.glob("*.so"))) == 1
+
+
+@needs_cc
+def test_native_int64(tmp_path):
+    """Test an int64 kernel and its overflow detection"""
+    kernel = compile_native({"quadrea": QUADREA}, "int64", cache_dir=tmp_path)
+    result = kernel(q_1=[2, 1, 5], q_2=[4, 1, 5], q_3=[6, 4, 8])
+    assert list(result["quadrea"]) == [32, 0, 96]
+    with pytest.raises(OverflowError, match="row 1"):
+        kernel(q_1=[1, 2**62], q_2=[1, 2**62], q_3=[1, 0])
+    with pytest.raises(TypeError, match="q_3"):
+        kernel(q_1=[1], q_2=[1])
+
+
+def test_fallback(tmp_path, monkeypatch):
+    """Test the fallback to the interpreted program without a compiler"""
+    monkeypatch.setenv("CC", "no-such-compiler")
+    prog = compile_native({"quadrea": QUADREA}, cache_dir=tmp_path)
+    assert isinstance(prog, Program)
+    with pytest.raises(RuntimeError):
+        compile_native({"quadrea": QUADREA}, fallback=False, cache_dir=tmp_path)
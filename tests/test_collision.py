@@ -0,0 +1,84 @@
+import random
+from fractions import Fraction
+
+from rat_trig.collision import (
+    UniformGrid,
+    circle_segment_overlap,
+    circles_overlap,
+    segment_cells,
+)
+
+
+def test_predicates():
+    """Test the exact narrow-phase predicates"""
+    assert circles_overlap((0, 0), 1, (3, 4), 4)  # touching counts
+    assert not circles_overlap((0, 0), 1, (3, 4), Fraction(39, 10))
+    assert circles_overlap((0.0, 0.0), 0.5, (0.5, 0.5), 0.25)
+
+    seg = ((0, 0), (4, 0))
+    assert circle_segment_overlap((2, 1), 1, *seg)
+    assert not circle_segment_overlap((2, Fraction(101, 100)), 1, *seg)
+    assert circle_segment_overlap((5, 0), 1, *seg)
+    assert not circle_segment_overlap((5, 1), 1, *seg)
+    assert circle_segment_overlap((-1, 0), 1, *seg)
+    assert circle_segment_overlap((1, 1), 1, (1, 0), (1, 0))
+
+
+def test_uniform_grid():
+    """Test the broad phase against all pairs, including incremental updates"""
+    rng = random.Random(7)
+    n = 60
+    xs = [Fraction(rng.randint(0, 400), 4) for _ in range(n)]
+    ys = [Fraction(rng.randint(0, 400), 4) for _ in range(n)]
+    radii = [Fraction(rng.randint(1, 12), 4) for _ in range(n)]
+
+    def brute_force():
+        return [
+            (i, j)
+            for i in range(n)
+            for j in range(i + 1, n)
+            if circles_overlap((xs[i], ys[i]), radii[i], (xs[j], ys[j]), radii[j])
+        ]
+
+    grid = UniformGrid(6, xs, ys, radii)
+    assert grid.overlapping_pairs() == brute_force()
+    candidates = grid.candidate_pairs()
+    assert len(candidates) == len(set(candidates))
+
+    for _ in range(5):
+        moved = rng.sample(range(n), 10)
+        for i in moved:
+            xs[i] += rng.randint(-8, 8)
+            ys[i] -= rng.randint(-8, 8)
+        grid.update(moved)
+        assert grid.overlapping_pairs() == brute_force()
+
+    segments = [((0, 50), (100, 50)), ((0, 0), (100, 100)), ((90, 3), (12, 6))]
+    segments += [((30, 10), (30, 90)), ((Fraction(1, 3), 97), (Fraction(299, 3), -1))]
+    for _ in range(20):
+        segments.append(
+            tuple((rng.randint(-10, 110), rng.randint(-10, 110)) for _ in "ab")
+        )
+    for a, b in segments:
+        assert grid.query_segment(a, b) == [
+            i
+            for i in range(n)
+            if circle_segment_overlap((xs[i], ys[i]), radii[i], a, b)
+        ]
+
+
+def test_segment_cells():
+    """Test that the cell walk covers the segment and stays near it"""
+    cells = set(segment_cells((0, 0), (600, 300), 6))
+    assert len(cells) <= 2 * (100 + 50) + 2  # the bounding box has 5151 cells
+    for k in range(601):
+        point = (Fraction(k), Fraction(k, 2))
+        assert (point[0] // 6, point[1] // 6) in cells
+    # through grid corners, in both directions and with negative coordinates
+    assert set(segment_cells((4, 4), (-4, -4), 2)) >= {
+        (1, 1),
+        (0, 0),
+        (-1, -1),
+        (-2, -2),
+    }
+    assert list(segment_cells((1, 5), (1, -3), 4)) == [(0, -1), (0, 0), (0, 1)]
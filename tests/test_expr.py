@@ -0,0 +1,87 @@
+import math
+import random
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.expr import compile_exprs, const, var
+from rat_trig.trigonom import archimedes
+
+
+def _formulas():
+    q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+    quadrea = archimedes(q_1, q_2, q_3)
+    return {
+        "quadrea": quadrea,
+        "spread_1": quadrea / (4 * q_2 * q_3),
+        "spread_2": quadrea / (4 * q_1 * q_3),
+        "circumquadrance": q_1 * q_2 * q_3 / quadrea,
+        "cross_3": (q_1 + q_2 - q_3) ** 2 / (4 * q_1 * q_2),
+    }
+
+
+def _direct(q_1, q_2, q_3):
+    quadrea = archimedes(q_1, q_2, q_3)
+    return {
+        "quadrea": quadrea,
+        "spread_1": quadrea / (4 * q_2 * q_3),
+        "spread_2": quadrea / (4 * q_1 * q_3),
+        "circumquadrance": q_1 * q_2 * q_3 / quadrea,
+        "cross_3": (q_1 + q_2 - q_3) ** 2 / (4 * q_1 * q_2),
+    }
+
+
+def test_sharing():
+    """Test hash-consing of shared subexpressions"""
+    a, b = var("a"), var("b")
+    assert a + b is b + a
+    assert a - b is not b - a
+    assert const(2) is not const(2.0)
+    formulas = _formulas()
+    prog = compile_exprs(formulas)
+    # q_1 + q_2 - q_3 and 4 * q_1 * q_2 are evaluated once
+    unshared = sum(compile_exprs({name: f}).size for name, f in formulas.items())
+    assert prog.size < unshared - 6
+    assert prog.variables == ["q_1", "q_2", "q_3"]
+
+
+@pytest.mark.parametrize("kind", [int, float, Fraction])
+def test_evaluate(kind):
+    """Test that the fused pass matches direct evaluation for each type"""
+    rng = random.Random(5)
+    rows = [
+        (kind(rng.randint(1, 50)), kind(rng.randint(1, 50)), kind(rng.randint(1, 50)))
+        for _ in range(30)
+    ]
+    rows = [r for r in rows if archimedes(*r) != 0]
+    prog = compile_exprs(_formulas())
+    cols = list(zip(*rows))
+    results = prog(q_1=cols[0], q_2=cols[1], q_3=cols[2])
+    for i, row in enumerate(rows):
+        expected = _direct(*row)
+        for name, value in expected.items():
+            assert results[name][i] == value
+            assert type(results[name][i]) is type(value)
+    assert prog.evaluate(q_1=rows[0][0], q_2=rows[0][1], q_3=rows[0][2]) == _direct(
+        *rows[0]
+    )
+    with pytest.raises(TypeError):
+        prog(q_1=cols[0])
+
+
+def test_no_variables():
+    """Test that formulas without variables are rejected"""
+    with pytest.raises(ValueError):
+        compile_exprs({"c": const(3) * const(4)})
+    with pytest.raises(ValueError):
+        compile_exprs({})
+
+
+def test_signed_zero():
+    """Test that the constants 0.0 and -0.0 are different nodes"""
+    x = var("x")
+    assert const(-0.0) is not const(0.0) and const(-0.0) is const(-0.0)
+    prog = compile_exprs({"pos": x * const(0.0), "neg": x * const(-0.0)})
+    results = prog(x=[1.0])
+    assert math.copysign(1.0, results["pos"][0]) == 1.0
+    assert math.copysign(1.0, results["neg"][0]) == -1.0
@@ -0,0 +1,92 @@
+import io
+import random
+from decimal import Decimal, localcontext
+from fractions import Fraction
+
+import pytest
+
+from rat_trig import fmt
+from rat_trig.fmt import format_column, format_rows, write_rows
+
+
+def _fractions(rng, n=500):
+    return [Fraction(rng.randint(-999, 999), rng.randint(1, 99)) for _ in range(n)]
+
+
+def test_fraction_style():
+    """Test that the fraction style matches str"""
+    values = _fractions(random.Random(46))
+    assert format_column(values) == list(map(str, values))
+    assert format_column([Fraction(1, 2), 3]) == ["1/2", "3"]
+    assert format_column([2**70, -1]) == [str(2**70), "-1"]
+    assert format_column([0.5, -2.0]) == ["0.5", "-2.0"]
+
+
+@pytest.mark.parametrize("digits", [0, 1, 4, 12])
+def test_exact_rounding(digits):
+    """Test decimal rounding against Decimal and scientific against float formatting"""
+    rng = random.Random(digits)
+    values = [
+        Fraction(rng.randint(-(10**12), 10**12), rng.randint(1, 10**9))
+        for _ in range(500)
+    ]
+    values += [
+        Fraction(1, 2),
+        Fraction(-5, 2),
+        Fraction(25, 1000),
+        Fraction(-1, 10**20),
+    ]
+    with localcontext() as ctx:
+        ctx.prec = 100
+        exact = [Decimal(v.numerator) / v.denominator for v in values]
+        decimals = [f"{d.quantize(Decimal(10) ** -digits):f}" for d in exact]
+    decimals = [s.lstrip("-") if not s.strip("-0.") else s for s in decimals]
+    assert format_column(values, "decimal", digits) == decimals
+    floats = list(map(float, values))
+    # where float rounding is exact enough, both agree
+    sci = format_column(values, "scientific", min(digits, 8))
+    assert sci[:-4] == [f"{f:.{min(digits, 8)}e}" for f in floats][:-4]
+
+
+def test_edge_cases():
+    """Test zeros, carries, signs and invalid arguments"""
+    assert format_column([0, Fraction(0)], "scientific", 2) == ["0.00e+00"] * 2
+    assert format_column([Fraction(999, 100)], "scientific", 1) == ["1.0e+01"]
+    # no negative zero
+    assert format_column([Fraction(-1, 3)], "decimal", 0) == ["0"]
+    assert format_column([Fraction(-1, 1000)], "decimal", 2) == ["0.00"]
+    assert format_column([7, -7], "decimal", 0) == ["7", "-7"]
+    assert format_column([1.25], "decimal", 1) == ["1.2"]
+    assert format_column([], "scientific") == []
+    with pytest.raises(ValueError):
+        format_column([1], "hex")
+    with pytest.raises(ValueError):
+        format_column([1], "decimal", -1)
+
+
+def test_format_rows():
+    """Test joining columns into delimited rows"""
+    columns = [
+        [1, 2, 3],
+        [Fraction(1, 2), Fraction(2, 3), Fraction(5)],
+        [0.5, 1.0, 2.0],
+    ]
+    assert (
+        format_rows(columns, delimiter="\t") == "1\t1/2\t0.5\n2\t2/3\t1.0\n3\t5\t2.0\n"
+    )
+    assert format_rows([[1], [2]]) == "1,2\n"
+    assert format_rows([]) == format_rows([[]]) == ""
+    out = io.StringIO()
+    write_rows(out, columns[:1], "decimal", 1)
+    assert out.getvalue() == "1.0\n2.0\n3.0\n"
+
+
+def test_public_getters(monkeypatch):
+    """Test the fallback for Python versions without the slots of Fraction"""
+    numerator, denominator = fmt._getters(("_no_numerator", "_no_denominator"))
+    assert (numerator(Fraction(2, 3)), denominator(Fraction(2, 3))) == (2, 3)
+    values = _fractions(random.Random(47), 50) + [7]
+    expected = [format_column(values, style) for style in fmt.STYLES]
+    monkeypatch.setattr(fmt, "_NUMERATOR", numerator)
+    monkeypatch.setattr(fmt, "_DENOMINATOR", denominator)
+    assert [format_column(values, style) for style in fmt.STYLES] == expected
@@ -0,0 +1,99 @@
+import json
+import os
+import subprocess
+import sys
+from array import array
+from fractions import Fraction
+
+from rat_trig.expr import compile_exprs, var
+from rat_trig.instrument import BitRecorder, instrument_kernel, instrumented
+from rat_trig.lazy import LazyFraction
+from rat_trig.trigonom import archimedes, archimedes_batch
+
+SRC = os.path.join(os.path.dirname(__file__), "..", "src")
+
+
+def test_instrumented():
+    """Test recording the arguments and results of a wrapped batch function"""
+    recorder = BitRecorder()
+    batch = instrumented(archimedes_batch, "batch", recorder)
+    q = [Fraction(1, 3), Fraction(5, 7)]
+    assert batch(q, q, q) == archimedes_batch(q, q, q)
+    assert batch(array("q", [1, 2]), (x for x in [3, 4]), [5, 6]) == [11, 32]
+    hists = recorder.histograms["batch"]
+    assert recorder.calls["batch"] == 2
+    assert hists["in_num"] == {1: 4, 2: 1, 3: 5}  # the generator is not consumed
+    assert hists["in_den"][2] == 3 and hists["in_den"][3] == 3
+    summary = recorder.to_dict()["batch"]
+    assert summary["out_num"]["count"] == 4
+    assert summary["out_den"]["histogram"] == {"1": 2, "2": 1, "6": 1}
+    recorder.record("g", "in", [1.5, 2.5])
+    assert "g" not in recorder.histograms
+
+
+def test_program_and_lazy():
+    """Test wrapped programs, lazy fractions and uncounted symbolic calls"""
+    recorder = BitRecorder()
+    q_1, q_2, q_3 = var("q_1"), var("q_2"), var("q_3")
+    program = instrumented(
+        compile_exprs({"quadrea": archimedes(q_1, q_2, q_3)}), "prog", recorder
+    )
+    program(q_1=[2**30], q_2=[2**30], q_3=[1])
+    assert recorder.to_dict()["prog.quadrea"]["calls"] == 1
+    assert recorder.histograms["prog"]["in_num"] == {31: 2, 1: 1}
+    lazy = LazyFraction(2, 4)
+    instrumented(archimedes, "f", recorder)(lazy, lazy, lazy)
+    assert recorder.histograms["f"]["in_den"] == {3: 3}  # unreduced, as stored
+    exprs = instrumented(archimedes, "expr", recorder)
+    exprs(q_1, q_2, q_3)
+    assert "expr" not in recorder.histograms and recorder.calls["expr"] == 0
+    recorder.clear()
+    assert recorder.to_dict() == {}
+
+
+def test_kernel():
+    """Test that a program kernel records its inputs once per call"""
+    recorder = BitRecorder()
+    x, y = var("x"), var("y")
+    program = compile_exprs({"sum": x + y, "prod": x * y})
+    kernel = instrument_kernel(program._kernel, program.outputs, recorder)
+    kernel([Fraction(1, 3)], [4])
+    kernel([1.5], [2.5])
+    assert recorder.calls == {"expr": 1, "expr.sum": 1, "expr.prod": 1}
+    assert recorder.histograms["expr"]["in_num"] == {1: 1, 3: 1}  # once, not per output
+    assert recorder.histograms["expr.prod"]["out_den"] == {2: 1}
+    assert sum(recorder.histograms["expr.sum"]["in_num"].values()) == 0
+
+
+def test_disabled_by_default():
+    """Test that nothing is wrapped without RAT_TRIG_BITS"""
+    if os.environ.get("RAT_TRIG_BITS"):
+        return
+    assert not hasattr(archimedes, "__wrapped__")
+    assert not hasattr(compile_exprs({"q": var("q")})._kernel, "__wrapped__")
+
+
+def test_environment(tmp_path):
+    """Test that RAT_TRIG_BITS writes the histograms at exit"""
+    path = tmp_path / "bits.json"
+    code = (
+        "from fractions import Fraction as F\n"
+        "from rat_trig.trigonom import archimedes, archimedes_batch\n"
+        "from rat_trig.expr import compile_exprs, var\n"
+        "archimedes(F(1, 2), F(1, 4), F(1, 6))\n"
+        "archimedes_batch([2**100], [1], [1])\n"
+        "compile_exprs({'sq': var('x') * var('x')})(x=[F(1, 2**20)])\n"
+    )
+    env = dict(os.environ, RAT_TRIG_BITS=str(path), PYTHONPATH=SRC)
+    subprocess.run([sys.executable, "-c", code], env=env, check=True)
+    data = json.loads(path.read_text())
+    assert sorted(data) == [
+        "expr",
+        "expr.sq",
+        "trigonom.archimedes",
+        "trigonom.archimedes_batch",
+    ]
+    assert data["trigonom.archimedes"]["out_den"]["histogram"] == {"8": 1}
+    assert data["trigonom.archimedes_batch"]["out_num"]["max"] == 200
+    assert data["expr.sq"]["out_den"]["max"] == 41
+    assert data["expr"]["in_den"]["max"] == 21 and data["expr"]["calls"] == 1
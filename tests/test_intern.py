@@ -0,0 +1,55 @@
+import random
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.intern import InternPool, hit_rate, memoized_archimedes
+from rat_trig.trigonom import archimedes
+
+
+def test_intern_pool():
+    """Test sharing and hit statistics of the intern pool"""
+    rng = random.Random(36)
+    pool = InternPool()
+    values = [Fraction(rng.randint(0, 5), rng.randint(1, 5)) for _ in range(500)]
+    interned = pool.intern_all(values)
+    assert interned == values
+    by_value = {}
+    for v in interned:
+        assert by_value.setdefault(v, v) is v
+    stats = pool.stats()
+    assert stats.hits + stats.misses == 500
+    assert stats.hit_rate > 0.9
+    assert hit_rate(stats) == stats.hit_rate
+    pool.clear()
+    assert len(pool) == 0 and pool.stats().hit_rate == 0.0
+
+
+def test_intern_pool_bounded():
+    """Test eviction in a bounded intern pool"""
+    pool = InternPool(maxsize=3)
+    for n in range(10):
+        pool.fraction(n, 1)
+    assert len(pool) == 3
+    assert pool.fraction(9) == 9
+    assert pool.hits == 1
+
+    # unreduced inputs add a reduced key as well, which must count towards the bound
+    pool = InternPool(maxsize=3)
+    for k in range(1, 200):
+        assert pool.fraction(2 * k, 2 * k + 2) == Fraction(k, k + 1)
+        assert len(pool) <= 3
+    with pytest.raises(ValueError):
+        InternPool(maxsize=0)
+
+
+def test_memoized_archimedes():
+    """Test the cached archimedes and its result types"""
+    rng = random.Random(37)
+    quadrea = memoized_archimedes(maxsize=16)
+    triples = [(rng.randint(0, 3), rng.randint(0, 3), 2) for _ in range(200)]
+    for t in triples:
+        assert quadrea(*t) == archimedes(*t)
+    assert hit_rate(quadrea.cache_info()) > 0.8
+    assert type(quadrea(Fraction(1), Fraction(1), Fraction(1))) is Fraction
+    assert type(quadrea(1, 1, 1)) is int
@@ -0,0 +1,81 @@
+import random
+from fractions import Fraction
+
+from rat_trig.interval import (
+    Interval,
+    archimedes_interval,
+    archimedes_interval_batch,
+    archimedes_sign_batch,
+)
+from rat_trig.trigonom import archimedes, quadrance
+
+
+def _exact_archimedes(q_1, q_2, q_3):
+    return archimedes(Fraction(q_1), Fraction(q_2), Fraction(q_3))
+
+
+def _near_degenerate(rng):
+    """Quadrances of almost collinear triangles, rounded to float"""
+    x, y = rng.uniform(1, 2), rng.uniform(1, 2)
+    t = rng.uniform(2, 3)
+    p = (t * x + rng.uniform(-1, 1) * 1e-12, t * y)
+    return (
+        quadrance((x, y), p),
+        quadrance((0.0, 0.0), p),
+        quadrance((0.0, 0.0), (x, y)),
+    )
+
+
+def test_interval():
+    """Test that interval operations enclose the exact result"""
+    third = Interval.from_value(Fraction(1, 3))
+    assert third.lo < Fraction(1, 3) < third.hi
+    assert Interval(2.0) * 4 - 1 == Interval(7.0)
+    x = Interval(-1.0, 2.0)
+    assert x * x == Interval(0.0, 4.0)
+    assert x * Interval(-1.0, 2.0) == Interval(-2.0, 4.0)
+    assert Interval(-1.0, 2.0) * Interval(-3.0, 1.0) == Interval(-6.0, 3.0)
+    assert 0.5 in Interval(0.0, 1.0) and Interval(0.0, 1.0).sign() is None
+    assert Interval.from_value(10**400).hi == float("inf")
+
+    x = Interval.from_value(0.1) + 0.2
+    assert x.lo < Fraction(0.1) + Fraction(0.2) < x.hi
+    assert archimedes(Interval(2.0), Interval(4.0), Interval(6.0)) == Interval(32.0)
+
+
+def test_certified_archimedes():
+    """Test enclosures and exact signs near degeneracy"""
+    rng = random.Random(11)
+    triples = [_near_degenerate(rng) for _ in range(200)]
+    triples += [(2.0, 4.0, 6.0), (1.0, 1.0, 4.0), (0.1, 0.2, 0.3)]
+    cols = list(zip(*triples))
+    los, his = archimedes_interval_batch(*cols)
+    exact = [_exact_archimedes(*t) for t in triples]
+    for lo, hi, value, t in zip(los, his, exact, triples):
+        assert lo <= value <= hi
+        assert archimedes_interval(*t) == Interval(lo, hi)
+
+    signs = archimedes_sign_batch(*cols)
+    assert signs == [(v > 0) - (v < 0) for v in exact]
+    assert signs[-3:] == [1, 0, 1]
+    # plain float evaluation gets some of these signs wrong
+    floats = [archimedes(*t) for t in triples]
+    assert any((f > 0) - (f < 0) != s for f, s in zip(floats, signs))
+
+    mixed = [Fraction(1, 3), 2, 0.5]
+    assert archimedes_sign_batch(*[[q] for q in mixed]) == [
+        (lambda v: (v > 0) - (v < 0))(_exact_archimedes(*mixed))
+    ]
+
+
+def test_underflow():
+    """Test that products underflowing to zero are widened, not treated as exact"""
+    x = Interval(1e-200) * Interval(1e-200)
+    assert x.lo < 0.0 < x.hi and x.sign() is None
+    assert Interval(0.0) * Interval(1e-200) == Interval(0.0)
+
+    cols = [[1e-170], [1e-170], [1e-170]]
+    los, his = archimedes_interval_batch(*cols)
+    assert los[0] <= _exact_archimedes(1e-170, 1e-170, 1e-170) <= his[0]
+    assert his[0] > 0.0
+    assert archimedes_sign_batch(*cols) == [1]
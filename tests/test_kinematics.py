@@ -0,0 +1,45 @@
+from fractions import Fraction
+
+from rat_trig.kinematics import (
+    Joint,
+    reachable_batch,
+    solve_three_link,
+    solve_two_link,
+    solve_two_link_batch,
+)
+
+
+def test_solve_two_link():
+    """Test the 3-4-5 configuration"""
+    sol = solve_two_link(25, 25, (8, 0))
+    assert sol.reachable
+    assert sol.base == Joint(0, 8, 0)
+    assert sol.shoulder == Joint(Fraction(9, 25), 32, 1)
+    assert sol.elbow == Joint(Fraction(576, 625), 7, -1)
+
+    down = solve_two_link(25, 25, (8, 0), elbow_up=False)
+    assert down.shoulder.turn == -1 and down.elbow.turn == 1
+
+    # fully stretched, and out of reach
+    assert solve_two_link(1, 4, (0, 3)).elbow == Joint(0, 2, 0)
+    assert not solve_two_link(1, 4, (0, 4)).reachable
+
+    sol = solve_two_link(0.5, 0.5, (0.0, 1.0))
+    assert sol.reachable and sol.elbow.spread == 1.0 and sol.elbow.dot == 0.0
+
+
+def test_batch():
+    """Test the batched API against the scalar one"""
+    half = Fraction(1, 2)
+    targets = [(8, 0), (3, -4), (0, 11), (half, half), (0, 0)]
+    assert reachable_batch(25, 25, targets) == [True, True, False, True, True]
+    assert solve_two_link_batch(25, 25, targets, False) == [
+        solve_two_link(25, 25, t, False) for t in targets
+    ]
+
+
+def test_solve_three_link():
+    """Test the wrist reduction"""
+    sol = solve_three_link(25, 25, (0, 2), (8, 2))
+    assert sol.arm == solve_two_link(25, 25, (8, 0))
+    assert sol.tool == Joint(1, 0, 1)
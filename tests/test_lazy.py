@@ -0,0 +1,53 @@
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.lazy import LazyFraction
+from rat_trig.trigonom import archimedes
+
+
+def test_lazy_fraction():
+    """Test arithmetic and interoperability with Fraction"""
+    a, b = LazyFraction(3, -4), LazyFraction(Fraction(5, 6))
+    fa, fb = Fraction(3, -4), Fraction(5, 6)
+    for got, expected in [
+        (a + b, fa + fb),
+        (a - b, fa - fb),
+        (a * b, fa * fb),
+        (a / b, fa / fb),
+        (2 - a, 2 - fa),
+        (fb / a, fb / fa),
+        (-a, -fa),
+        (abs(a), abs(fa)),
+        (a**-3, fa**-3),
+        (1 + a * 0, 1),
+    ]:
+        assert isinstance(got, LazyFraction)
+        assert got == expected and hash(got) == hash(expected)
+    assert a + 0.25 == -0.5 and isinstance(a * 2.0, float)
+    assert a < b <= fb < 1 and b > 0.5 and not a * 0
+    assert not (a == float("nan"))
+    assert {LazyFraction(4, 2), 2, Fraction(2)} == {2}
+    assert str(LazyFraction(6, 4)) == "3/2"
+    with pytest.raises(ZeroDivisionError):
+        a / 0
+
+
+def test_normalization():
+    """Test that reduction is deferred and bounded"""
+    x = LazyFraction(2, 4) * 2
+    assert (x._num, x._den) == (4, 4)
+    assert (x.numerator, x.denominator) == (1, 1)
+
+    q = LazyFraction(1, 3)
+    for _ in range(200):
+        q = q * LazyFraction(3, 7) / LazyFraction(3, 7)
+    assert q._den.bit_length() <= LazyFraction.max_bits + 10
+    assert q == Fraction(1, 3)
+
+
+def test_archimedes():
+    """Test Archimedes' formula with LazyFraction"""
+    q = [LazyFraction(1, 2), LazyFraction(1, 4), LazyFraction(1, 6)]
+    assert archimedes(*q) == Fraction(23, 144)
+    assert repr(archimedes(*q)) == "LazyFraction(23, 144)"
@@ -0,0 +1,103 @@
+import struct
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.mesh import iter_degenerate, quadrea_chunk, read_triangles, scan_mesh
+
+VERTICES = [(0, 0, 0), (1, 0, 0), (0, 1, 0), (2, 0, 0), (0, 0, 1)]
+FACES = [(0, 1, 2), (0, 1, 3), (1, 2, 4), (0, 3, 2, 4)]
+
+
+def _write_obj(path):
+    lines = [f"v {x} {y} {z}" for x, y, z in VERTICES]
+    lines += ["o part"] + ["f " + " ".join(f"{i + 1}//1" for i in f) for f in FACES]
+    path.write_text("\n".join(lines) + "\n")
+
+
+def _ply_header(fmt):
+    return (
+        f"ply\nformat {fmt} 1.0\ncomment test\n"
+        f"element vertex {len(VERTICES)}\n"
+        "property float x\nproperty float y\nproperty float z\nproperty uchar red\n"
+        f"element face {len(FACES)}\n"
+        "property list uchar int vertex_indices\nproperty uchar flags\nend_header\n"
+    ).encode("ascii")
+
+
+def _write_ply_ascii(path):
+    body = [f"{x} {y} {z} 255" for x, y, z in VERTICES]
+    body += [f"{len(f)} " + " ".join(map(str, f)) + " 0" for f in FACES]
+    path.write_bytes(_ply_header("ascii") + ("\n".join(body) + "\n").encode())
+
+
+def _write_ply_binary(path, endian):
+    fmt = "binary_little_endian" if endian == "<" else "binary_big_endian"
+    data = b"".join(struct.pack(endian + "fffB", *v, 255) for v in VERTICES)
+    for f in FACES:
+        data += struct.pack(f"{endian}B{len(f)}iB", len(f), *f, 0)
+    path.write_bytes(_ply_header(fmt) + data)
+
+
+def _stl_triangles():
+    for f in FACES:
+        for k in range(1, len(f) - 1):
+            yield [VERTICES[f[0]], VERTICES[f[k]], VERTICES[f[k + 1]]]
+
+
+def _write_stl_binary(path):
+    tris = list(_stl_triangles())
+    data = b"\0" * 80 + struct.pack("<I", len(tris))
+    for tri in tris:
+        data += struct.pack("<12fH", 0, 0, 0, *tri[0], *tri[1], *tri[2], 0)
+    path.write_bytes(data)
+
+
+def _write_stl_ascii(path):
+    lines = ["solid part"]
+    for tri in _stl_triangles():
+        lines += ["facet normal 0 0 0", "outer loop"]
+        lines += [f"vertex {x} {y} {z}" for x, y, z in tri]
+        lines += ["endloop", "endfacet"]
+    path.write_text("\n".join(lines + ["endsolid part"]) + "\n")
+
+
+WRITERS = {
+    "mesh.obj": _write_obj,
+    "mesh_ascii.ply": _write_ply_ascii,
+    "mesh_le.ply": lambda p: _write_ply_binary(p, "<"),
+    "mesh_be.ply": lambda p: _write_ply_binary(p, ">"),
+    "mesh_ascii.stl": _write_stl_ascii,
+    "mesh_binary.stl": _write_stl_binary,
+}
+
+
+@pytest.mark.parametrize("name", sorted(WRITERS))
+def test_scan_mesh(tmp_path, name):
+    """Test that all formats give the same statistics"""
+    path = tmp_path / name
+    WRITERS[name](path)
+    stats = scan_mesh(path, chunk_size=2)
+    # the STL writer emits the quad as two separate facets
+    assert stats.faces == (5 if name.endswith(".stl") else 4)
+    assert stats.degenerate_count == 1
+    assert stats.degenerate == [1]
+    assert list(iter_degenerate(path)) == [1]
+    assert sum(stats.total_quadrea.values()) == 4 + 0 + 12 + 16 + 4
+    assert stats.min_quadrea == 0
+    assert stats.max_quadrea == 16
+
+
+def test_quadrea_chunk(tmp_path):
+    """Test exact quadreas and parts"""
+    path = tmp_path / "mesh.obj"
+    _write_obj(path)
+    triangles = list(read_triangles(path))
+    assert [t[0] for t in triangles] == ["part"] * 5
+    assert [t[1] for t in triangles] == [0, 1, 2, 3, 3]
+    quadreas = quadrea_chunk(triangles, exact=True)
+    assert quadreas == [4, 0, 12, 16, 4]
+    assert all(isinstance(q, Fraction) for q in quadreas)
+    assert scan_mesh(path, max_reported=0).degenerate == []
+    with pytest.raises(ValueError):
+        scan_mesh(tmp_path / "mesh.off")
@@ -0,0 +1,169 @@
+import random
+import shutil
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.parse import (
+    ParseError,
+    iter_chunks,
+    parse_column,
+    parse_rational,
+    to_numbers,
+)
+
+
+@pytest.mark.parametrize(
+    "token",
+    [
+        "0",
+        "-17",
+        "+3",
+        " 12 ",
+        "-123/456",
+        "1.25",
+        "-.5",
+        "5.",
+        "3e-2",
+        "-1.5E3",
+        "2e0",
+    ],
+)
+def test_parse_rational(token):
+    """Test parsing single literals exactly"""
+    num, den = parse_rational(token)
+    assert den > 0
+    assert Fraction(num, den) == Fraction(token.replace(" ", ""))
+    assert parse_rational("4/-6") == (-4, 6)
+
+
+@pytest.mark.parametrize(
+    "token",
+    [
+        "",
+        ".",
+        "1/0",
+        "1.5/2",
+        "abc",
+        "1e",
+        "--1",
+        "1.2.3",
+        "٣",
+        "1e99999",
+        "1_000",
+        "1_0/3",
+        "٣/4",
+        "1e1_0",
+        "nan",
+        "inf",
+    ],
+)
+def test_parse_rational_invalid(token):
+    """Test that malformed literals are rejected"""
+    with pytest.raises(ValueError):
+        parse_rational(token)
+
+
+def test_parse_column():
+    """Test the fast paths and the field parser on whole columns"""
+    big = str(2**80)
+    nums, dens = parse_column(["1", big, "-3"])
+    assert dens is None and list(nums) == [1, 2**80, -3]
+    nums, dens = parse_column(["1/3", "2.5"])
+    assert nums.typecode == "q" and list(zip(nums, dens)) == [(1, 3), (25, 10)]
+    assert to_numbers(nums, dens, "fraction") == [Fraction(1, 3), Fraction(5, 2)]
+    assert to_numbers(nums, dens, "float") == [1 / 3, 2.5]
+    assert to_numbers(*parse_column(["4/2", "3"]), "int") == [2, 3]
+    with pytest.raises(ValueError):
+        to_numbers(nums, dens, "int")
+    with pytest.raises(ValueError):
+        to_numbers(nums, dens, "complex")
+
+
+@pytest.mark.parametrize(
+    "fields, index",
+    [
+        (["1", "٣"], 1),
+        (["1_000", "2"], 0),
+        (["1/3", "1_0/3"], 1),
+        (["٣/4", "1/2", "0.5"], 0),
+    ],
+)
+def test_parse_column_invalid(fields, index):
+    """Test that the fast paths reject what the field parser rejects"""
+    with pytest.raises(ValueError) as info:
+        parse_column(fields)
+    assert info.value.index == index
+
+
+def test_iter_chunks_invalid():
+    """Test that non-ASCII digits are rejected in every numeric type"""
+    for kind in ("int", "fraction", "float"):
+        with pytest.raises(ParseError) as info:
+            list(iter_chunks(["1,2", "3,٣"], 2, kind))
+        assert (info.value.line, info.value.field) == (2, 2)
+    with pytest.raises(ParseError):
+        list(iter_chunks(["1.5", "nan"], 1, "float"))
+
+
+def test_iter_chunks():
+    """Test chunked parsing against the original values"""
+    rng = random.Random(43)
+    values = [
+        [Fraction(rng.randint(-999, 999), rng.randint(1, 99)) for _ in range(3)]
+        for _ in range(1000)
+    ]
+    lines = ["# header"] + ["\t".join(map(str, row)) for row in values]
+    chunks = list(iter_chunks(lines, 3, chunk_size=300))
+    assert len(chunks) == 4
+    assert [list(r) for c in chunks for r in zip(*c)] == values
+    floats = list(iter_chunks(["1.5,1/4"], 2, "float"))
+    assert floats == [[[1.5], [0.25]]]
+
+
+def test_parse_error():
+    """Test the line and field numbers of parse errors"""
+    with pytest.raises(ParseError) as info:
+        list(iter_chunks(["1,2", "", "3,4/0"], 2, chunk_size=1, first_line=10))
+    assert (info.value.line, info.value.field) == (12, 2)
+    assert str(info.value).startswith("line 12, field 2:")
+    with pytest.raises(ParseError, match="expected 2 fields"):
+        list(iter_chunks(["1,2,3"], 2))
+
+
+def test_float_overflow():
+    """Test that values too large for a float raise ParseError"""
+    with pytest.raises(ParseError) as info:
+        list(iter_chunks(["1/2,2", "1e400,1"], 2, "float"))
+    assert (info.value.line, info.value.field) == (2, 1)
+    with pytest.raises(ParseError, match="out of range for float"):
+        list(iter_chunks([f"{10**400}/3"], 1, "float"))
+
+
+@pytest.mark.skipif(shutil.which("cc") is None, reason="no C compiler")
+@pytest.mark.parametrize("kind", ["int", "fraction", "float"])
+def test_native(kind, tmp_path, monkeypatch):
+    """Test the C tokenizer against the Python parser"""
+    monkeypatch.setenv("RAT_TRIG_CACHE", str(tmp_path))
+    rng = random.Random(44)
+
+    def field():
+        if kind == "int" or rng.random() < 0.5:
+            return str(rng.randint(-(2**63), 2**63 - 1))
+        return f"{rng.randint(-999, 999)}/{rng.randint(1, 99)}"
+
+    lines = ["# header"] + [",".join(field() for _ in range(3)) for _ in range(1000)]
+    lines[500:500] = ["\r\n", "-9223372036854775808,+0,0\r\n"]
+    expected = list(iter_chunks(lines, 3, kind, chunk_size=300))
+    assert list(iter_chunks(lines, 3, kind, chunk_size=300, native=True)) == expected
+    assert list(tmp_path.iterdir())  # the tokenizer was built
+
+    # fields the C tokenizer does not handle fall back to the Python parser
+    def parse(lines, native):
+        try:
+            return list(iter_chunks(lines, 3, kind, native=native))
+        except ParseError as err:
+            return err.line, err.field
+
+    for row in ("1, 2,3", "1,2,3,", f"{2**63},1,1", "1.5,2,3", "1,2/0,3", "1,2/-3,3"):
+        assert parse([row, "1,2,3"], True) == parse([row, "1,2,3"], False)
@@ -0,0 +1,63 @@
+import random
+from fractions import Fraction
+
+from rat_trig.projective import (
+    join,
+    join_batch,
+    meet,
+    meet_batch,
+    normalize,
+    point,
+    quadrea,
+    quadrea_batch,
+    reduce_content,
+    to_affine,
+)
+from rat_trig.trigonom import archimedes, quadrance
+
+
+def test_meet_join():
+    """Test constructions against Fraction arithmetic"""
+    p, q = point(Fraction(1, 2), 3), point(-2, Fraction(5, 7))
+    line = join(p, q)
+    for x in (p, q):
+        assert sum(a * b for a, b in zip(line, x)) == 0
+    assert to_affine(p) == (Fraction(1, 2), 3)
+
+    # intersection of the diagonals of a square
+    d_1 = join(point(0, 0), point(2, 2))
+    d_2 = join(point(2, 0), point(0, 2))
+    assert to_affine(meet(d_1, d_2)) == (1, 1)
+    # parallel lines meet at infinity
+    assert to_affine(meet(d_1, join(point(1, 0), point(3, 2)))) is None
+
+    assert normalize((0, 0, 0)) == (0, 0, 0)
+    assert reduce_content((2**70, 2**71, 2**72), 64) == (1, 2, 4)
+    assert reduce_content((2, 4, 6), 64) == (2, 4, 6)
+
+
+def test_batch():
+    """Test batch constructions and exact quadreas"""
+    rng = random.Random(3)
+
+    def rand_point():
+        return point(
+            Fraction(rng.randint(-50, 50), rng.randint(1, 9)), rng.randint(-9, 9)
+        )
+
+    ps = [rand_point() for _ in range(40)]
+    qs = [rand_point() for _ in range(40)]
+    rs = [rand_point() for _ in range(40)]
+    lines = join_batch(ps, qs, max_bits=8)
+    assert [normalize(l) for l in lines] == [
+        normalize(join(p, q)) for p, q in zip(ps, qs)
+    ]
+    points = meet_batch(lines, join_batch(qs, rs), max_bits=8)
+    assert [normalize(x) for x in points] == [normalize(q) for q in qs]
+
+    nums, dens = quadrea_batch(ps, qs, rs)
+    for p, q, r, n, d in zip(ps, qs, rs, nums, dens):
+        a, b, c = to_affine(p), to_affine(q), to_affine(r)
+        expected = archimedes(quadrance(b, c), quadrance(a, c), quadrance(a, b))
+        assert Fraction(n, d) == expected
+        assert (n, d) == quadrea(p, q, r)
@@ -0,0 +1,125 @@
+import gc
+import random
+import struct
+import weakref
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.ratfile import (
+    MAX_COLUMNS,
+    RatFileError,
+    RatReader,
+    RatWriter,
+    write_ratfile,
+)
+from rat_trig.trigonom import archimedes_batch
+
+
+def _column(rng, n, big=False):
+    top = 2**100 if big else 2**40
+    return [Fraction(rng.randint(-top, top), rng.randint(1, top)) for _ in range(n)]
+
+
+def test_round_trip(tmp_path):
+    """Test that chunked columns of all sizes read back unchanged"""
+    rng = random.Random(41)
+    path = tmp_path / "data.rat"
+    cols = {
+        "small": _column(rng, 100),
+        "big": _column(rng, 100, big=True),
+        "int": [rng.randint(-(2**62), 2**62) for _ in range(100)],
+        "huge": [rng.randint(-(2**200), 2**200) for _ in range(100)],
+    }
+    assert write_ratfile(path, cols, chunk_size=30) == 100
+    with RatReader(path) as reader:
+        assert (
+            reader.columns == list(cols) and reader.num_rows == 100 and len(reader) == 4
+        )
+        assert reader.read_all() == cols
+        chunk = reader.chunk(1)
+        assert chunk.is_integer("int") and not chunk.is_integer("huge")
+        assert chunk.integers("int").tolist() == cols["int"][30:60]
+        with pytest.raises(ValueError):
+            chunk.integers("small")
+        with pytest.raises(KeyError):
+            chunk.values("missing")
+
+
+def test_zero_copy_kernels(tmp_path):
+    """Test the batch kernels on zero-copy integer views"""
+    path = tmp_path / "q.rat"
+    rng = random.Random(42)
+    qs = [[rng.randint(0, 1000) for _ in range(50)] for _ in range(3)]
+    with RatWriter(path, ["q_1", "q_2", "q_3"]) as writer:
+        writer.write_chunk(dict(zip(["q_1", "q_2", "q_3"], qs)))
+        writer.write_chunk({"q_1": [], "q_2": [], "q_3": []})
+        with pytest.raises(ValueError):
+            writer.write_chunk({"q_1": [1], "q_2": [], "q_3": []})
+    with RatReader(path) as reader:
+        chunk = next(iter(reader))
+        views = [chunk.integers(n) for n in reader.columns]
+        assert all(isinstance(v, memoryview) for v in views)
+        assert archimedes_batch(*views) == archimedes_batch(*qs)
+        del views, chunk
+
+
+def test_close_with_live_views(tmp_path):
+    """Test that closing defers unmapping to the release of the last view"""
+    path = tmp_path / "q.rat"
+    write_ratfile(path, {"q": [3, 1, 4]})
+    reader = RatReader(path)
+    view = reader.chunk(0).integers("q")
+    mapping = weakref.ref(reader._map)
+    reader.close()
+    assert reader._file.closed
+    assert view.tolist() == [3, 1, 4] and mapping() is not None
+    view.release()
+    gc.collect()
+    assert mapping() is None
+    reader.close()  # idempotent
+    with pytest.raises(ValueError):
+        reader.chunk(0)
+
+
+def test_invalid(tmp_path):
+    """Test that malformed files and column names are rejected"""
+    path = tmp_path / "bad.rat"
+    path.write_bytes(b"not a rat file at all")
+    with pytest.raises(RatFileError):
+        RatReader(path)
+    good = tmp_path / "good.rat"
+    write_ratfile(good, {"q": [1, 2, 3]})
+    path.write_bytes(good.read_bytes()[:-8])
+    with pytest.raises(RatFileError):
+        RatReader(path)
+    with pytest.raises(ValueError):
+        RatWriter(tmp_path / "x.rat", ["a\nb"])
+
+
+def test_max_columns(tmp_path):
+    """Test the 64-column limit of the integer mask"""
+    path = tmp_path / "wide.rat"
+    cols = {f"c{k}": [k, Fraction(1, k + 2)] for k in range(MAX_COLUMNS)}
+    cols["c63"] = [2**62, -(2**62)]
+    write_ratfile(path, cols)
+    with RatReader(path) as reader:
+        assert reader.read_all() == cols
+        assert reader.chunk(0).is_integer("c63")
+    with pytest.raises(RatFileError):
+        RatWriter(tmp_path / "x.rat", [f"c{k}" for k in range(MAX_COLUMNS + 1)])
+
+
+@pytest.mark.parametrize("offset", [1000, -8, 16])
+def test_corrupt_overflow(tmp_path, offset):
+    """Test that a bad overflow offset raises RatFileError"""
+    path = tmp_path / "q.rat"
+    write_ratfile(path, {"q": [Fraction(2**70, 3)]})
+    data = bytearray(path.read_bytes())
+    # the numerator slot of the only value, after the 24-byte header and chunk header
+    assert struct.unpack_from("<qq", data, 48) == (0, 0)
+    struct.pack_into("<q", data, 48, offset)
+    path.write_bytes(bytes(data))
+    with RatReader(path) as reader:
+        with pytest.raises(RatFileError):
+            reader.read_all()
@@ -0,0 +1,51 @@
+import math
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.rotation import Rotation, compose_all
+
+
+def test_rotation():
+    """Test the canonical form and composition"""
+    r = Rotation(-6, -8, -10)
+    assert (r.a, r.b, r.c) == (3, 4, 5)
+    assert r.spread == Fraction(16, 25)
+    assert r == Rotation.from_half_tangent(Fraction(1, 2))
+    assert len({r, Rotation(3, 4, 5), r.inverse()}) == 2
+    assert r * r.inverse() == Rotation.identity()
+    with pytest.raises(ValueError):
+        Rotation(1, 1, 1)
+
+    points = [(1, 2), (Fraction(1, 3), -5)]
+    xs, ys, c = r.apply_scaled([1, 2], [2, 0])
+    assert r.apply([(1, 2), (2, 0)]) == [
+        (Fraction(x, c), Fraction(y, c)) for x, y in zip(xs, ys)
+    ]
+    assert (r * r).apply(points) == r.apply(r.apply(points))
+
+
+def test_compose_all():
+    """Test lazily reduced composition against the pairwise product"""
+    rots = [Rotation(3, 4, 5), Rotation(5, -12, 13), Rotation(8, 15, 17)] * 7
+    rots += [Rotation(-4, 3, 5).inverse(), Rotation(4, 3, 5)]
+    product = Rotation.identity()
+    for rot in rots:
+        product = product * rot
+    assert compose_all(rots, max_bits=16) == product
+    assert compose_all(rots) == product
+    assert compose_all([]) == Rotation.identity()
+
+
+def test_snap():
+    """Test that snapping respects the height bound and stays close"""
+    rot = compose_all([Rotation(3, 4, 5), Rotation(5, 12, 13)] * 20)
+    angle = math.atan2(rot.b, rot.a)
+    for height in (1, 2, 5, 30, 1000, 10**6):
+        snapped = rot.snap(height)
+        assert snapped.c <= height
+        assert snapped.a**2 + snapped.b**2 == snapped.c**2
+        assert abs(math.atan2(snapped.b, snapped.a) - angle) < 4 / math.sqrt(height)
+    assert Rotation(20, 99, 101).snap(30) == Rotation(7, 24, 25)
+    assert Rotation(-99, 20, 101).snap(30) == Rotation(-24, 7, 25)
+    assert rot.snap(rot.c) is rot
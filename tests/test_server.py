@@ -0,0 +1,179 @@
+import asyncio
+import os
+import struct
+import tempfile
+import threading
+from fractions import Fraction
+
+import pytest
+
+from rat_trig import server as server_module
+from rat_trig.server import (
+    ERROR,
+    FRAME,
+    INT64,
+    RATIONAL,
+    BatchServer,
+    Client,
+    decode_results,
+    encode_request,
+    read_frame,
+)
+from rat_trig.trigonom import archimedes
+
+
+@pytest.fixture
+def running():
+    """Start servers on a background event loop; returns a starter function"""
+    loop = asyncio.new_event_loop()
+    thread = threading.Thread(target=loop.run_forever, daemon=True)
+    thread.start()
+    servers = []
+
+    def start(**kwargs):
+        future = asyncio.run_coroutine_threadsafe(BatchServer.start(**kwargs), loop)
+        servers.append(future.result(5))
+        return servers[-1]
+
+    yield start
+    for server in servers:
+        asyncio.run_coroutine_threadsafe(server.close(), loop).result(5)
+    loop.call_soon_threadsafe(loop.stop)
+    thread.join(5)
+    loop.close()
+
+
+def test_tcp(running):
+    """Test a client over TCP"""
+    server = running(port=0)
+    with Client(server.address) as client:
+        assert client.archimedes([2, 1, 2**40], [4, 1, 2**40], [6, 4, 2**40]) == [
+            32,
+            0,
+            3 * 2**80,
+        ]
+        q = [Fraction(1, 2), Fraction(-3, 4), 5]
+        assert client.archimedes(q, q, q) == [archimedes(x, x, x) for x in q]
+        assert client.archimedes([], [], []) == []
+        metrics = client.metrics()
+    assert metrics["requests"] == 3 and metrics["triangles"] == 6
+    assert metrics["queue_depth"] == 0
+
+
+@pytest.mark.skipif(not hasattr(asyncio, "start_unix_server"), reason="no AF_UNIX")
+def test_unix(running):
+    """Test a client over a Unix domain socket"""
+    path = os.path.join(tempfile.mkdtemp(), "rat-trig.sock")
+    running(path=path)
+    with Client(path) as client:
+        assert client.archimedes([1], [1], [1]) == [3]
+
+
+def test_errors(running):
+    """Test that malformed requests get error replies on a surviving connection"""
+    server = running(port=0)
+    with Client(server.address) as client:
+        with pytest.raises(ValueError, match="zero denominator"):
+            _, frame = encode_request(1, [Fraction(1, 2)], [1], [1])
+            frame = frame[: -8 * 5] + struct.pack("<q", 0) + frame[-8 * 4 :]
+            client._call(frame)
+        with pytest.raises(ValueError, match="payload bytes"):
+            client._call(FRAME.pack(FRAME.size - 4 + 8, 9, INT64, 1) + bytes(8))
+        with pytest.raises(ValueError, match="unknown request kind"):
+            client._call(FRAME.pack(FRAME.size - 4, 9, 7, 0))
+        # the connection survives errors
+        assert client.archimedes([1], [1], [1]) == [3]
+
+
+def test_reply_failure(running, monkeypatch):
+    """Test that a failure while encoding a reply is sent as an error"""
+
+    def broken(kind, results):
+        raise OverflowError("cannot encode")
+
+    server = running(port=0)
+    monkeypatch.setattr(server_module, "encode_results", broken)
+    with Client(server.address) as client:
+        client._sock.settimeout(5)
+        with pytest.raises(ValueError, match="cannot encode"):
+            client.archimedes([1], [1], [1])
+        monkeypatch.undo()
+        assert client.archimedes([1], [1], [1]) == [3]
+
+
+def test_coalescing():
+    """Test that concurrent requests are evaluated in shared batches"""
+
+    async def main():
+        server = await BatchServer.start(port=0, deadline=0.05)
+        connections = [
+            await asyncio.open_connection(*server.address) for _ in range(20)
+        ]
+        for k, (_, writer) in enumerate(connections):
+            writer.write(encode_request(k, [k], [k + 1], [k + 2])[1])
+        results = {}
+        for reader, writer in connections:
+            request_id, status, count, payload = await read_frame(reader)
+            results[request_id] = decode_results(INT64, count, payload)
+            writer.close()
+        await server.close()
+        return server.metrics, results
+
+    metrics, results = asyncio.run(main())
+    assert results == {k: [archimedes(k, k + 1, k + 2)] for k in range(20)}
+    assert metrics.requests == 20 and metrics.triangles == 20
+    assert metrics.batches < 20
+    assert metrics.max_queue_depth >= 1
+    assert sum(metrics.batch_sizes.values()) == metrics.batches
+
+
+def test_pipelined_mixed_kinds():
+    """Test pipelined int64 and rational requests on one connection"""
+
+    async def main():
+        server = await BatchServer.start(port=0, deadline=0.01, max_batch=4)
+        reader, writer = await asyncio.open_connection(*server.address)
+        kinds = {}
+        for k in range(6):
+            q = Fraction(k, 3) if k % 2 else k
+            kinds[k], frame = encode_request(k, [q] * 2, [q] * 2, [q] * 2)
+            writer.write(frame)
+        responses = [await read_frame(reader) for _ in range(6)]
+        writer.write(FRAME.pack(2, 99, INT64, 0))  # shorter than the header
+        bad = await read_frame(reader)
+        writer.close()
+        await server.close()
+        return kinds, responses, bad
+
+    kinds, responses, bad = asyncio.run(main())
+    assert {kinds[k] for k in kinds} == {INT64, RATIONAL}
+    for request_id, status, count, payload in responses:
+        q = Fraction(request_id, 3) if request_id % 2 else request_id
+        assert status == 0 and count == 2
+        assert (
+            decode_results(kinds[request_id], count, payload)
+            == [archimedes(q, q, q)] * 2
+        )
+    assert bad[1] == ERROR
+
+
+def test_backpressure(monkeypatch):
+    """Test that a connection has at most MAX_IN_FLIGHT requests unanswered"""
+    monkeypatch.setattr(server_module, "MAX_IN_FLIGHT", 2)
+
+    async def main():
+        server = await BatchServer.start(port=0, deadline=0.2)
+        reader, writer = await asyncio.open_connection(*server.address)
+        for k in range(5):
+            writer.write(encode_request(k, [k], [k], [k])[1])
+        await asyncio.sleep(0.1)
+        read_early = server.metrics.requests  # while the first batch waits
+        responses = [await read_frame(reader) for _ in range(5)]
+        writer.close()
+        await server.close()
+        return read_early, responses
+
+    read_early, responses = asyncio.run(main())
+    assert read_early == 2
+    assert sorted(r[0] for r in responses) == list(range(5))
+    assert server_module.MAX_FRAME <= 1 << 26
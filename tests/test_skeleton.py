@@ -1,25 +1,136 @@
+import io
+import random
+from fractions import Fraction
+
 import pytest
 
-from rat_trig.skeleton import fib, main
+from rat_trig.parse import ParseError
+from rat_trig.ratfile import RatReader, write_ratfile
+from rat_trig.skeleton import (
+    byte_ranges,
+    build_program,
+    main,
+    process_stream,
+)
 
 __author__ = "Wai-Shing Luk"
 __copyright__ = "Wai-Shing Luk"
 __license__ = "MIT"
 
 
-def test_fib():
+def test_build_program():
     """API Tests"""
-    assert fib(1) == 1
-    assert fib(2) == 1
-    assert fib(7) == 13
-    with pytest.raises(AssertionError):
-        fib(-10)
+    prog = build_program(["quadrea", "spread_3"])
+    assert prog.evaluate(q_1=2, q_2=4, q_3=6) == {"quadrea": 32, "spread_3": 1.0}
+    prog = build_program(["q_3", "quadrea"], "coords")
+    result = prog.evaluate(x_1=0, y_1=0, x_2=3, y_2=0, x_3=0, y_3=4)
+    assert result == {"q_3": 9, "quadrea": 4 * 9 * 16}
+
+
+def test_process_stream():
+    """Test evaluating a stream of CSV lines"""
+    lines = ["# comment\n", "1\t1\t4\n", "\n", "1/2\t0.25\t1/6\n"]
+    prog = build_program(["quadrea"])
+    out = io.StringIO()
+    assert process_stream(lines, prog, "fraction", out, chunk_size=1) == 2
+    assert out.getvalue() == "quadrea\n0\n23/144\n"
+    with pytest.raises(ParseError, match="line 2"):
+        process_stream(["1,2,3", "1,2"], prog, "fraction", io.StringIO())
+    with pytest.raises(ParseError, match="line 3, field 2"):
+        process_stream(["1,2,3", "", "1,x,3"], prog, "int", io.StringIO())
 
 
-def test_main(capsys):
+def test_main(capsys, tmp_path, monkeypatch):
     """CLI Tests"""
     # capsys is a pytest fixture that allows asserts against stdout/stderr
     # https://docs.pytest.org/en/stable/capture.html
-    main(["7"])
+    path = tmp_path / "triangles.csv"
+    path.write_text("0,0,1,0,0,1\n0,0,2,2,4,4\n")
+    assert main(["-i", "coords", "-t", "int", "--stats", str(path)]) == 0
     captured = capsys.readouterr()
-    assert "The 7-th Fibonacci number is 13" in captured.out
+    assert captured.out == "quadrea\n4\n0\n"
+    assert "2 rows" in captured.err
+    assert main(["-t", "int", "-f", "spread_1", str(path)]) == 2
+    assert main([str(path)]) == 1
+    out = tmp_path / "out.csv"
+    monkeypatch.setattr("sys.stdin", io.StringIO("2\t4\t6\n"))
+    assert main(["-f", "q_1", "-f", "quadrea", "--no-header", "-o", str(out), "-"]) == 0
+    assert out.read_text() == "2,32\n"
+
+
+def test_main_ratfile(capsys, tmp_path):
+    """Test the CLI on rat file input"""
+    path = tmp_path / "triangles.rat"
+    write_ratfile(path, {"q_1": [2, 1], "q_2": [4, Fraction(1, 2)], "q_3": [6, 1]})
+    assert main(["-f", "quadrea", "-f", "spread_3", str(path)]) == 0
+    assert capsys.readouterr().out == "quadrea,spread_3\n32,1\n7/4,7/8\n"
+    assert main(["-t", "float", "--no-header", str(path)]) == 0
+    assert capsys.readouterr().out == "32.0\n1.75\n"
+    assert main(["-t", "int", str(path)]) == 1
+    assert main(["-i", "coords", str(path)]) == 1
+
+
+def test_main_jobs(capsys, caplog, tmp_path, monkeypatch):
+    """Test that --jobs matches the serial output and reports absolute line numbers"""
+    rng = random.Random(1)
+    path = tmp_path / "triangles.tsv"
+    lines = ["# q_1\tq_2\tq_3"]
+    lines += [
+        "\t".join(f"{rng.randint(1, 99)}/{rng.randint(1, 9)}" for _ in range(3))
+        for _ in range(2000)
+    ]
+    path.write_text("\n".join(lines) + "\n")
+    args = ["-f", "quadrea", "-f", "spread_3", "-f", "quadrea", str(path)]
+    assert main(args) == 0
+    serial = capsys.readouterr().out
+    assert main(["--jobs", "2", "--chunk-bytes", "1000"] + args) == 0
+    assert capsys.readouterr().out == serial
+    assert serial.count("\n") == 2001
+    monkeypatch.setenv("RAT_TRIG_CACHE", str(tmp_path / "cache"))
+    for jobs in ("1", "2"):
+        assert main(["--native-parse", "-j", jobs, "--chunk-bytes", "1000"] + args) == 0
+        assert capsys.readouterr().out == serial
+    assert list(byte_ranges(path, 1000))[-1][1] == path.stat().st_size
+    bad = tmp_path / "bad.csv"
+    bad.write_text("1,2,3\n" * 500 + "1,2\n")
+    assert main(["-j", "2", "--chunk-bytes", "100", str(bad)]) == 1
+    assert "line 501" in caplog.text
+    with pytest.raises(SystemExit):
+        main(["-j", "2", str(path), "-"])
+
+
+def test_main_jobs_line_endings(capsys, caplog, tmp_path):
+    """Test that --jobs splits lines like the serial reader"""
+    path = tmp_path / "triangles.csv"
+    # separators that str.splitlines splits on, in comments and around records
+    lines = ["# a\u2028b\x85c\x0cd\x1ee", "1,2,3\r", "2,4,6\r\n4,5,6"] * 50
+    path.write_bytes("\n".join(lines).encode() + b"\n")
+    args = ["-f", "quadrea", "--no-header", str(path)]
+    assert main(args) == 0
+    serial = capsys.readouterr().out
+    assert serial.count("\n") == 150
+    assert main(["-j", "2", "--chunk-bytes", "100"] + args) == 0
+    assert capsys.readouterr().out == serial
+    path.write_bytes(path.read_bytes() + b"\r1,2\n")
+    assert main(["-j", "2", "--chunk-bytes", "100"] + args) == 1
+    assert "line 202" in caplog.text
+
+
+def test_main_output(capsys, tmp_path):
+    """Test the output formats and rat file output"""
+    path = tmp_path / "triangles.csv"
+    path.write_text("2,4,6\n1/2,1/3,1/5\n")
+    args = ["-f", "quadrea", "-f", "spread_3", str(path)]
+    assert main(["--format", "decimal", "--digits", "3"] + args) == 0
+    assert capsys.readouterr().out == "quadrea,spread_3\n32.000,1.000\n0.266,0.398\n"
+    assert main(["--format", "scientific", "--digits", "1", "--no-header"] + args) == 0
+    assert capsys.readouterr().out == "3.2e+01,1.0e+00\n2.7e-01,4.0e-01\n"
+    rat = tmp_path / "out.rat"
+    for jobs in ("1", "2"):
+        assert main(["-o", str(rat), "-j", jobs, "--chunk-bytes", "4"] + args) == 0
+        with RatReader(rat) as reader:
+            assert reader.read_all() == {
+                "quadrea": [32, Fraction(239, 900)],
+                "spread_3": [1, Fraction(239, 600)],
+            }
+    assert main(["-o", str(rat), "-t", "float"] + args) == 2
@@ -0,0 +1,59 @@
+import random
+from fractions import Fraction
+
+import pytest
+
+from rat_trig.trigonom import quadrance
+from rat_trig.vector import Vector, VectorArray
+
+
+def _random_vectors(rng, n, dim, big=2**40):
+    return [tuple(rng.randint(-big, big) for _ in range(dim)) for _ in range(n)]
+
+
+def test_vector():
+    """Test the exact operations of a single vector"""
+    u = Vector((Fraction(1, 2), 0, 1, 2, 0, 1))
+    v = Vector((0, Fraction(1, 3), 1, 0, 1, 1))
+    assert len(u) == 6
+    assert u.quadrance_to(v) == quadrance(u, v)
+    assert u.dot(v) == 2
+    assert u.spread(v) == 1 - Fraction(4) / (u.quadrance() * v.quadrance())
+    assert u.spread(u * 3) == 0
+    assert Vector((1, 0)).spread(Vector((0, 5))) == 1
+    assert -u + u == Vector((0,) * 6)
+    assert {u, Vector(u)} == {u}
+    with pytest.raises(ValueError):
+        u.dot(Vector((1, 2)))
+    with pytest.raises(ZeroDivisionError):
+        u.spread(Vector((0,) * 6))
+
+
+@pytest.mark.parametrize("typecode", ["q", "d", ""])
+def test_vector_array(typecode):
+    """Test the column kernels against the scalar operations"""
+    dim = 6
+    rng = random.Random(37)
+    vs, ws = _random_vectors(rng, 50, dim), _random_vectors(rng, 50, dim)
+    if typecode == "d":
+        vs = [tuple(float(c % 100) for c in v) for v in vs]
+        ws = [tuple(float(c % 100) + 1 for c in w) for w in ws]
+    a = VectorArray.from_vectors(vs, typecode=typecode)
+    b = VectorArray.from_vectors(ws, typecode=typecode)
+    assert a.typecode == typecode and len(a) == 50 and a[-1] == Vector(vs[-1])
+    assert a.quadrances() == [Vector(v).quadrance() for v in vs]
+    assert a.dots(b) == [Vector(v).dot(Vector(w)) for v, w in zip(vs, ws)]
+    assert a.quadrances_to(b) == [quadrance(v, w) for v, w in zip(vs, ws)]
+    spreads = a.spreads(b)
+    for s, v, w in zip(spreads, vs, ws):
+        assert s == pytest.approx(Vector(v).spread(Vector(w)))
+    assert list(a.roll(1))[1:] == list(a)[:-1]
+
+
+def test_vector_array_int64_no_overflow():
+    """Test that quadrances of int64 storage are exact beyond int64"""
+    big = 2**62
+    a = VectorArray.from_vectors([(big, big, big)], typecode="q")
+    assert a.quadrances() == [3 * big * big]
+    with pytest.raises(ValueError):
+        VectorArray(a.data, 2)